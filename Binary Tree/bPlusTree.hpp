@@ -0,0 +1,522 @@
+#ifndef B_PLUS_TREE_HPP
+#define B_PLUS_TREE_HPP
+
+#include <vector>
+#include <utility>
+#include <iostream>
+#include <iterator>
+#include <algorithm>
+#include <type_traits>
+#include <stdexcept>
+#include <cstddef>
+#include "simdSearch.hpp"
+
+template<typename V>
+struct bPlusValueSize { static constexpr size_t value = sizeof(V); };
+template<>
+struct bPlusValueSize<void> { static constexpr size_t value = 0; };
+
+constexpr int bPlusFit(size_t bytes, size_t per){
+    return static_cast<int>(bytes / per) < 4 ? 4 : static_cast<int>(bytes / per);
+}
+
+template<typename V, int N>
+struct bPlusLeafValues { V vals[N]; };
+template<int N>
+struct bPlusLeafValues<void, N> {};
+
+// In-memory B+-tree. With Value = void it is an ordered set, otherwise an
+// ordered map from Key to Value. Each node is sized to roughly NodeBytes,
+// so one node holds dozens of integer keys in a few cache lines instead of
+// one key per 40+ byte binary node. Every key lives in a leaf, and the
+// leaves form a doubly linked list, so range scans read leaves in order.
+//
+// Key (and Value) must be default constructible and copy assignable; keys
+// are unique, and inserting an existing key of a map overwrites its value.
+template<typename Key, typename Value = void, size_t NodeBytes = 512>
+class bPlusTree {
+    static_assert(NodeBytes >= 128 && NodeBytes <= 65536, "NodeBytes should be between 128 B and 64 KB");
+
+    static constexpr bool IS_MAP = !std::is_void<Value>::value;
+    static constexpr size_t HEADER = 2 * sizeof(int);
+    static constexpr int LEAF_CAP = bPlusFit(NodeBytes - HEADER - 2 * sizeof(void*), sizeof(Key) + bPlusValueSize<Value>::value);
+    static constexpr int INNER_CAP = bPlusFit(NodeBytes - HEADER - sizeof(void*), sizeof(Key) + sizeof(void*));
+    static constexpr int LEAF_MIN = LEAF_CAP / 2;
+    static constexpr int INNER_MIN = INNER_CAP / 2;
+    static constexpr int MAX_HEIGHT = 48;
+
+    struct nodeBase {
+        int count;
+        bool leaf;
+    };
+    struct leafNode : nodeBase {
+        leafNode* prev;
+        leafNode* next;
+        Key keys[LEAF_CAP];
+        bPlusLeafValues<Value, LEAF_CAP> values;
+    };
+    struct innerNode : nodeBase {
+        Key keys[INNER_CAP];
+        nodeBase* children[INNER_CAP + 1];
+    };
+
+    nodeBase* root;
+    leafNode* first;
+    leafNode* last;
+    int size_;
+
+    static int lowerBound_(const Key* keys, int count, const Key& key);
+    static int route_(const Key* keys, int count, const Key& key);
+    static leafNode* newLeaf_();
+    static innerNode* newInner_();
+    static void moveEntry_(leafNode* from, int i, leafNode* to, int j);
+    leafNode* findLeaf_(const Key& key) const;
+    template<typename V>
+    bool insert_(const Key& key, const V* value);
+    bool remove_(const Key& key);
+    void fixLeaf_(leafNode* node, innerNode* parent, int i);
+    bool fixInner_(innerNode* node, innerNode* parent, int i);
+    void clear_(nodeBase* tmp);
+
+public:
+    bPlusTree() noexcept : root(nullptr), first(nullptr), last(nullptr), size_(0) {}
+    bPlusTree(const bPlusTree&) = delete;
+    bPlusTree& operator=(const bPlusTree&) = delete;
+    ~bPlusTree() { clear(); }
+
+    template<typename V = Value>
+    typename std::enable_if<std::is_void<V>::value>::type insert(const Key& key) { insert_(key, static_cast<const char*>(nullptr)); }
+    template<typename V = Value>
+    typename std::enable_if<!std::is_void<V>::value>::type insert(const Key& key, const V& value) { insert_(key, &value); }
+    void remove(const Key& key) { remove_(key); }
+    bool search(const Key& key) const;
+    template<typename V = Value>
+    typename std::enable_if<!std::is_void<V>::value, V*>::type find(const Key& key);
+    void clear();
+    int size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    static constexpr int leafCapacity() { return LEAF_CAP; }
+    static constexpr int innerCapacity() { return INNER_CAP; }
+    void display() const;
+
+    class iterator {
+        leafNode* leaf;
+        int pos;
+        const bPlusTree* tree;
+        friend class bPlusTree;
+        iterator(leafNode* leaf_, int pos_, const bPlusTree* tree_) : leaf(leaf_), pos(pos_), tree(tree_) {}
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = Key;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Key*;
+        using reference = const Key&;
+
+        iterator() : leaf(nullptr), pos(0), tree(nullptr) {}
+        reference operator*() const { return leaf->keys[pos]; }
+        pointer operator->() const { return &leaf->keys[pos]; }
+        template<typename V = Value>
+        typename std::enable_if<!std::is_void<V>::value, V&>::type value() const { return leaf->values.vals[pos]; }
+        iterator& operator++(){
+            if(++pos == leaf->count){
+                leaf = leaf->next;
+                pos = 0;
+            }
+            return *this;
+        }
+        iterator operator++(int) { iterator tmp = *this; ++*this; return tmp; }
+        iterator& operator--(){
+            if(!leaf){
+                leaf = tree->last;
+                pos = leaf->count - 1;
+            }
+            else if(pos-- == 0){
+                leaf = leaf->prev;
+                pos = leaf->count - 1;
+            }
+            return *this;
+        }
+        iterator operator--(int) { iterator tmp = *this; --*this; return tmp; }
+        bool operator==(const iterator& other) const { return leaf == other.leaf && pos == other.pos; }
+        bool operator!=(const iterator& other) const { return !(*this == other); }
+    };
+    using const_iterator = iterator;
+
+    iterator begin() const { return iterator(first, 0, this); }
+    iterator end() const { return iterator(nullptr, 0, this); }
+    iterator lower_bound(const Key& key) const;
+    iterator upper_bound(const Key& key) const;
+    template<typename Fn>
+    void for_each_in_range(const Key& lo, const Key& hi, Fn fn) const;
+};
+
+// Index of the first key not less than `key`. Arithmetic keys scan the
+// whole node with the SIMD counting kernel; other keys use binary search.
+template<typename Key, typename Value, size_t NodeBytes>
+int bPlusTree<Key, Value, NodeBytes>::lowerBound_(const Key* keys, int count, const Key& key){
+    if constexpr (std::is_arithmetic<Key>::value){
+        return static_cast<int>(simdCountLess(keys, static_cast<size_t>(count), key));
+    }
+    else return static_cast<int>(std::lower_bound(keys, keys + count, key) - keys);
+}
+
+// Child to descend into: the number of separators not greater than `key`.
+template<typename Key, typename Value, size_t NodeBytes>
+int bPlusTree<Key, Value, NodeBytes>::route_(const Key* keys, int count, const Key& key){
+    if constexpr (std::is_arithmetic<Key>::value){
+        return count - static_cast<int>(simdCountGreater(keys, static_cast<size_t>(count), key));
+    }
+    else return static_cast<int>(std::upper_bound(keys, keys + count, key) - keys);
+}
+
+template<typename Key, typename Value, size_t NodeBytes>
+typename bPlusTree<Key, Value, NodeBytes>::leafNode* bPlusTree<Key, Value, NodeBytes>::newLeaf_(){
+    leafNode* leaf = new leafNode();
+    leaf->count = 0;
+    leaf->leaf = true;
+    leaf->prev = leaf->next = nullptr;
+    return leaf;
+}
+
+template<typename Key, typename Value, size_t NodeBytes>
+typename bPlusTree<Key, Value, NodeBytes>::innerNode* bPlusTree<Key, Value, NodeBytes>::newInner_(){
+    innerNode* inner = new innerNode();
+    inner->count = 0;
+    inner->leaf = false;
+    return inner;
+}
+
+template<typename Key, typename Value, size_t NodeBytes>
+void bPlusTree<Key, Value, NodeBytes>::moveEntry_(leafNode* from, int i, leafNode* to, int j){
+    to->keys[j] = std::move(from->keys[i]);
+    if constexpr (IS_MAP) to->values.vals[j] = std::move(from->values.vals[i]);
+}
+
+template<typename Key, typename Value, size_t NodeBytes>
+typename bPlusTree<Key, Value, NodeBytes>::leafNode* bPlusTree<Key, Value, NodeBytes>::findLeaf_(const Key& key) const{
+    nodeBase* tmp = root;
+    while(tmp && !tmp->leaf){
+        innerNode* inner = static_cast<innerNode*>(tmp);
+        tmp = inner->children[route_(inner->keys, inner->count, key)];
+    }
+    return static_cast<leafNode*>(tmp);
+}
+
+template<typename Key, typename Value, size_t NodeBytes>
+bool bPlusTree<Key, Value, NodeBytes>::search(const Key& key) const{
+    leafNode* leaf = findLeaf_(key);
+    if(!leaf) return false;
+    int pos = lowerBound_(leaf->keys, leaf->count, key);
+    return pos < leaf->count && !(key < leaf->keys[pos]);
+}
+
+template<typename Key, typename Value, size_t NodeBytes>
+template<typename V>
+typename std::enable_if<!std::is_void<V>::value, V*>::type bPlusTree<Key, Value, NodeBytes>::find(const Key& key){
+    leafNode* leaf = findLeaf_(key);
+    if(!leaf) return nullptr;
+    int pos = lowerBound_(leaf->keys, leaf->count, key);
+    if(pos < leaf->count && !(key < leaf->keys[pos])) return &leaf->values.vals[pos];
+    return nullptr;
+}
+
+// Descends recording the path, inserts into the leaf and splits full nodes
+// bottom-up; a split root grows the tree by one level.
+template<typename Key, typename Value, size_t NodeBytes>
+template<typename V>
+bool bPlusTree<Key, Value, NodeBytes>::insert_(const Key& key, const V* value){
+    if(!root){
+        first = last = newLeaf_();
+        root = first;
+    }
+    innerNode* path[MAX_HEIGHT];
+    int index[MAX_HEIGHT];
+    int depth = 0;
+    nodeBase* tmp = root;
+    while(!tmp->leaf){
+        innerNode* inner = static_cast<innerNode*>(tmp);
+        int i = route_(inner->keys, inner->count, key);
+        path[depth] = inner;
+        index[depth++] = i;
+        tmp = inner->children[i];
+    }
+    leafNode* leaf = static_cast<leafNode*>(tmp);
+    int pos = lowerBound_(leaf->keys, leaf->count, key);
+    if(pos < leaf->count && !(key < leaf->keys[pos])){
+        if constexpr (IS_MAP) leaf->values.vals[pos] = *value;
+        return false;
+    }
+
+    if(leaf->count == LEAF_CAP){
+        leafNode* right = newLeaf_();
+        int keep = (LEAF_CAP + 1) / 2;
+        for(int j = keep; j < LEAF_CAP; ++j) moveEntry_(leaf, j, right, j - keep);
+        right->count = LEAF_CAP - keep;
+        leaf->count = keep;
+        right->next = leaf->next;
+        right->prev = leaf;
+        if(leaf->next) leaf->next->prev = right;
+        else last = right;
+        leaf->next = right;
+        if(pos > keep){
+            pos -= keep;
+            leaf = right;
+        }
+        for(int j = leaf->count; j > pos; --j) moveEntry_(leaf, j - 1, leaf, j);
+        leaf->keys[pos] = key;
+        if constexpr (IS_MAP) leaf->values.vals[pos] = *value;
+        ++leaf->count;
+        ++size_;
+
+        Key sep = right->keys[0];
+        nodeBase* child = right;
+        while(depth > 0){
+            innerNode* parent = path[--depth];
+            int i = index[depth];
+            if(parent->count < INNER_CAP){
+                for(int j = parent->count; j > i; --j){
+                    parent->keys[j] = std::move(parent->keys[j - 1]);
+                    parent->children[j + 1] = parent->children[j];
+                }
+                parent->keys[i] = std::move(sep);
+                parent->children[i + 1] = child;
+                ++parent->count;
+                return true;
+            }
+            Key keys[INNER_CAP + 1];
+            nodeBase* children[INNER_CAP + 2];
+            for(int j = 0, k = 0; j <= INNER_CAP; ++j){
+                if(j == i) keys[j] = sep;
+                else keys[j] = std::move(parent->keys[k++]);
+            }
+            for(int j = 0, k = 0; j <= INNER_CAP + 1; ++j){
+                if(j == i + 1) children[j] = child;
+                else children[j] = parent->children[k++];
+            }
+            int mid = (INNER_CAP + 1) / 2;
+            innerNode* sibling = newInner_();
+            parent->count = mid;
+            for(int j = 0; j < mid; ++j) parent->keys[j] = std::move(keys[j]);
+            for(int j = 0; j <= mid; ++j) parent->children[j] = children[j];
+            sibling->count = INNER_CAP - mid;
+            for(int j = 0; j < sibling->count; ++j) sibling->keys[j] = std::move(keys[mid + 1 + j]);
+            for(int j = 0; j <= sibling->count; ++j) sibling->children[j] = children[mid + 1 + j];
+            sep = std::move(keys[mid]);
+            child = sibling;
+        }
+        innerNode* top = newInner_();
+        top->count = 1;
+        top->keys[0] = std::move(sep);
+        top->children[0] = root;
+        top->children[1] = child;
+        root = top;
+        return true;
+    }
+
+    for(int j = leaf->count; j > pos; --j) moveEntry_(leaf, j - 1, leaf, j);
+    leaf->keys[pos] = key;
+    if constexpr (IS_MAP) leaf->values.vals[pos] = *value;
+    ++leaf->count;
+    ++size_;
+    return true;
+}
+
+// Separators are only lower bounds of their right subtree, so a removal
+// never has to rewrite them unless nodes are merged or keys are borrowed.
+template<typename Key, typename Value, size_t NodeBytes>
+bool bPlusTree<Key, Value, NodeBytes>::remove_(const Key& key){
+    if(!root) return false;
+    innerNode* path[MAX_HEIGHT];
+    int index[MAX_HEIGHT];
+    int depth = 0;
+    nodeBase* tmp = root;
+    while(!tmp->leaf){
+        innerNode* inner = static_cast<innerNode*>(tmp);
+        int i = route_(inner->keys, inner->count, key);
+        path[depth] = inner;
+        index[depth++] = i;
+        tmp = inner->children[i];
+    }
+    leafNode* leaf = static_cast<leafNode*>(tmp);
+    int pos = lowerBound_(leaf->keys, leaf->count, key);
+    if(pos == leaf->count || key < leaf->keys[pos]) return false;
+
+    for(int j = pos + 1; j < leaf->count; ++j) moveEntry_(leaf, j, leaf, j - 1);
+    --leaf->count;
+    --size_;
+
+    if(depth == 0){
+        if(leaf->count == 0){
+            delete leaf;
+            root = nullptr;
+            first = last = nullptr;
+        }
+        return true;
+    }
+    if(leaf->count >= LEAF_MIN) return true;
+
+    fixLeaf_(leaf, path[depth - 1], index[depth - 1]);
+    while(--depth > 0){
+        if(!fixInner_(path[depth], path[depth - 1], index[depth - 1])) return true;
+    }
+    if(root->count == 0){
+        innerNode* old = static_cast<innerNode*>(root);
+        root = old->children[0];
+        delete old;
+    }
+    return true;
+}
+
+// Refills an underfull leaf from a sibling, or merges it with one and
+// removes the separator between them from the parent.
+template<typename Key, typename Value, size_t NodeBytes>
+void bPlusTree<Key, Value, NodeBytes>::fixLeaf_(leafNode* node, innerNode* parent, int i){
+    leafNode* left = i > 0 ? static_cast<leafNode*>(parent->children[i - 1]) : nullptr;
+    leafNode* right = i < parent->count ? static_cast<leafNode*>(parent->children[i + 1]) : nullptr;
+    if(left && left->count > LEAF_MIN){
+        for(int j = node->count; j > 0; --j) moveEntry_(node, j - 1, node, j);
+        moveEntry_(left, left->count - 1, node, 0);
+        --left->count;
+        ++node->count;
+        parent->keys[i - 1] = node->keys[0];
+        return;
+    }
+    if(right && right->count > LEAF_MIN){
+        moveEntry_(right, 0, node, node->count);
+        for(int j = 1; j < right->count; ++j) moveEntry_(right, j, right, j - 1);
+        --right->count;
+        ++node->count;
+        parent->keys[i] = right->keys[0];
+        return;
+    }
+    if(!left){
+        left = node;
+        node = right;
+        ++i;
+    }
+    for(int j = 0; j < node->count; ++j) moveEntry_(node, j, left, left->count + j);
+    left->count += node->count;
+    left->next = node->next;
+    if(node->next) node->next->prev = left;
+    else last = left;
+    delete node;
+    for(int j = i; j < parent->count; ++j){
+        parent->keys[j - 1] = std::move(parent->keys[j]);
+        parent->children[j] = parent->children[j + 1];
+    }
+    --parent->count;
+}
+
+// Same for inner nodes, rotating keys through the parent. Returns whether
+// the parent lost a key and may now be underfull itself.
+template<typename Key, typename Value, size_t NodeBytes>
+bool bPlusTree<Key, Value, NodeBytes>::fixInner_(innerNode* node, innerNode* parent, int i){
+    if(node->count >= INNER_MIN) return false;
+    innerNode* left = i > 0 ? static_cast<innerNode*>(parent->children[i - 1]) : nullptr;
+    innerNode* right = i < parent->count ? static_cast<innerNode*>(parent->children[i + 1]) : nullptr;
+    if(left && left->count > INNER_MIN){
+        for(int j = node->count; j > 0; --j) node->keys[j] = std::move(node->keys[j - 1]);
+        for(int j = node->count + 1; j > 0; --j) node->children[j] = node->children[j - 1];
+        node->keys[0] = std::move(parent->keys[i - 1]);
+        node->children[0] = left->children[left->count];
+        parent->keys[i - 1] = std::move(left->keys[left->count - 1]);
+        --left->count;
+        ++node->count;
+        return false;
+    }
+    if(right && right->count > INNER_MIN){
+        node->keys[node->count] = std::move(parent->keys[i]);
+        node->children[node->count + 1] = right->children[0];
+        ++node->count;
+        parent->keys[i] = std::move(right->keys[0]);
+        for(int j = 1; j < right->count; ++j) right->keys[j - 1] = std::move(right->keys[j]);
+        for(int j = 1; j <= right->count; ++j) right->children[j - 1] = right->children[j];
+        --right->count;
+        return false;
+    }
+    if(!left){
+        left = node;
+        node = right;
+        ++i;
+    }
+    left->keys[left->count] = std::move(parent->keys[i - 1]);
+    for(int j = 0; j < node->count; ++j) left->keys[left->count + 1 + j] = std::move(node->keys[j]);
+    for(int j = 0; j <= node->count; ++j) left->children[left->count + 1 + j] = node->children[j];
+    left->count += node->count + 1;
+    delete node;
+    for(int j = i; j < parent->count; ++j){
+        parent->keys[j - 1] = std::move(parent->keys[j]);
+        parent->children[j] = parent->children[j + 1];
+    }
+    --parent->count;
+    return true;
+}
+
+template<typename Key, typename Value, size_t NodeBytes>
+typename bPlusTree<Key, Value, NodeBytes>::iterator bPlusTree<Key, Value, NodeBytes>::lower_bound(const Key& key) const{
+    leafNode* leaf = findLeaf_(key);
+    if(!leaf) return end();
+    int pos = lowerBound_(leaf->keys, leaf->count, key);
+    if(pos == leaf->count) return iterator(leaf->next, 0, this);
+    return iterator(leaf, pos, this);
+}
+
+template<typename Key, typename Value, size_t NodeBytes>
+typename bPlusTree<Key, Value, NodeBytes>::iterator bPlusTree<Key, Value, NodeBytes>::upper_bound(const Key& key) const{
+    iterator it = lower_bound(key);
+    if(it != end() && !(key < *it)) ++it;
+    return it;
+}
+
+// Calls fn on every key in [lo, hi] in order, walking the leaf chain.
+template<typename Key, typename Value, size_t NodeBytes>
+template<typename Fn>
+void bPlusTree<Key, Value, NodeBytes>::for_each_in_range(const Key& lo, const Key& hi, Fn fn) const{
+    iterator it = lower_bound(lo);
+    leafNode* leaf = it.leaf;
+    int pos = it.pos;
+    while(leaf){
+        for(; pos < leaf->count; ++pos){
+            if(hi < leaf->keys[pos]) return;
+            fn(leaf->keys[pos]);
+        }
+        leaf = leaf->next;
+        pos = 0;
+    }
+}
+
+template<typename Key, typename Value, size_t NodeBytes>
+void bPlusTree<Key, Value, NodeBytes>::clear(){
+    clear_(root);
+    root = nullptr;
+    first = last = nullptr;
+    size_ = 0;
+}
+
+template<typename Key, typename Value, size_t NodeBytes>
+void bPlusTree<Key, Value, NodeBytes>::clear_(nodeBase* tmp){
+    if(!tmp) return;
+    if(tmp->leaf){
+        delete static_cast<leafNode*>(tmp);
+        return;
+    }
+    innerNode* inner = static_cast<innerNode*>(tmp);
+    for(int i = 0; i <= inner->count; ++i) clear_(inner->children[i]);
+    delete inner;
+}
+
+template<typename Key, typename Value, size_t NodeBytes>
+void bPlusTree<Key, Value, NodeBytes>::display() const{
+    if(empty()){
+        std::cout << "Tree empty" << std::endl;
+        return;
+    }
+    for(leafNode* leaf = first; leaf; leaf = leaf->next){
+        std::cout << "[ ";
+        for(int i = 0; i < leaf->count; ++i) std::cout << leaf->keys[i] << " ";
+        std::cout << "] ";
+    }
+    std::cout << std::endl;
+}
+
+#endif
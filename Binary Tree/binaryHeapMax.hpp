@@ -4,9 +4,14 @@
 #include <cmath>  
 #include <vector>
 #include <utility>
+#include <iterator>
 #include <iostream>
 #include <initializer_list>
 #include <stdexcept>
+#include <type_traits>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 template<typename T>
 class binaryHeapMax{
@@ -17,15 +22,27 @@ class binaryHeapMax{
     int getRight(int i) const;
     int getParent(int i) const;
     void build();
+    void buildParallel(unsigned threads);
     int start() { return (size_ / 2) - 1;}
     void heapify(int i, int size);
+    void siftUp(int i);
+    void restore(int from);
 public:
     binaryHeapMax() noexcept;
     binaryHeapMax(const binaryHeapMax<T>& other);
     binaryHeapMax(std::initializer_list<T> init);
+    explicit binaryHeapMax(std::vector<T>&& init);
+    template<typename InputIt, typename = std::enable_if_t<std::is_base_of<std::input_iterator_tag,
+             typename std::iterator_traits<InputIt>::iterator_category>::value>>
+    binaryHeapMax(InputIt first, InputIt last);
     binaryHeapMax<T>& operator=(const binaryHeapMax<T>& other);
 
     void push(const T& value);
+    template<typename InputIt>
+    void push_range(InputIt first, InputIt last);
+    void merge(const binaryHeapMax<T>& other);
+    void merge(binaryHeapMax<T>&& other);
+    void rebuild(unsigned threads = std::thread::hardware_concurrency());
     const T& top() const;
     void pop();
     void clear() { data.clear(); size_ = 0;}
@@ -51,6 +68,20 @@ binaryHeapMax<T>::binaryHeapMax(std::initializer_list<T> init){
     size_ = data.size();
     build();
 }
+
+template<typename T>
+binaryHeapMax<T>::binaryHeapMax(std::vector<T>&& init) : data(std::move(init)){
+    size_ = data.size();
+    build();
+}
+
+template<typename T>
+template<typename InputIt, typename>
+binaryHeapMax<T>::binaryHeapMax(InputIt first, InputIt last) : data(first, last){
+    size_ = data.size();
+    build();
+}
+
 template<typename T>
 binaryHeapMax<T>& binaryHeapMax<T>::operator=(const binaryHeapMax<T>& other){
     if(this == &other) return *this;
@@ -84,7 +115,61 @@ template<typename T>
 void binaryHeapMax<T>::push(const T& value) { 
     data.push_back(value);
     ++size_;
-    int i = size_ - 1;
+    siftUp(size_ - 1);
+};
+
+template<typename T>
+template<typename InputIt>
+void binaryHeapMax<T>::push_range(InputIt first, InputIt last){
+    int from = size_;
+    data.insert(data.end(), first, last);
+    size_ = data.size();
+    restore(from);
+}
+
+template<typename T>
+void binaryHeapMax<T>::merge(const binaryHeapMax<T>& other){
+    if(this == &other){
+        binaryHeapMax<T> copy(other);
+        merge(std::move(copy));
+        return;
+    }
+    push_range(other.data.begin(), other.data.end());
+}
+
+template<typename T>
+void binaryHeapMax<T>::merge(binaryHeapMax<T>&& other){
+    if(this == &other) return merge(static_cast<const binaryHeapMax<T>&>(other));
+    if(empty()){
+        data = std::move(other.data);
+        size_ = data.size();
+    }
+    else{
+        if(data.size() < other.data.size()) std::swap(data, other.data);
+        int from = data.size();
+        data.insert(data.end(), std::make_move_iterator(other.data.begin()),
+                    std::make_move_iterator(other.data.end()));
+        size_ = data.size();
+        restore(from);
+    }
+    other.clear();
+}
+
+// Elements [from, size_) were appended to a valid heap of size `from`.
+// Sifting each of them up costs about k*log(n) comparisons, a full rebuild
+// about 2n, so pick whichever is cheaper for this batch.
+template<typename T>
+void binaryHeapMax<T>::restore(int from){
+    int added = size_ - from;
+    if(added <= 0) return;
+    if(static_cast<double>(added) * std::log2(size_ + 1) < 2.0 * size_){
+        for(int i = from; i < size_; ++i) siftUp(i);
+    }
+    else build();
+}
+
+template<typename T>
+void binaryHeapMax<T>::siftUp(int i){
     while(i > 0){
         int parent = getParent(i);
         if(parent == -1) break;
@@ -94,7 +179,7 @@ void binaryHeapMax<T>::push(const T& value) {
         }
         else break;
     }
-};
+}
 
 template<typename T>
 void binaryHeapMax<T>::heapify(int i, int size){
@@ -119,6 +204,71 @@ void binaryHeapMax<T>::build(){
     }
 }
 
+// Restores the heap property with `threads` workers. The heap never starts
+// threads on its own: constructors, push_range and merge build on the
+// calling thread, and callers that want a parallel build ask for it here.
+template<typename T>
+void binaryHeapMax<T>::rebuild(unsigned threads){
+    buildParallel(threads);
+}
+
+// Floyd's construction processed one level at a time, bottom-up. Nodes of a
+// single level root disjoint subtrees, so each worker heapifies a contiguous
+// slice of the level and waits for the others before moving one level up.
+// Once a level is too narrow to split, the remaining top is finished on the
+// calling thread.
+template<typename T>
+void binaryHeapMax<T>::buildParallel(unsigned threads){
+    int last = start();
+    if(last < 0) return;
+    const int minSlice = 1 << 12;
+    if(threads <= 1 || last + 1 < 2 * minSlice){
+        for(int i = last; i >= 0; --i) heapify(i, size_);
+        return;
+    }
+
+    int deepest = 0;
+    while((2 << deepest) - 1 <= last) ++deepest;
+    int level = deepest;
+    while(level > 0 && (1 << level) / minSlice >= 2) --level;
+    int sharedTop = level;
+
+    std::mutex m;
+    std::condition_variable cv;
+    unsigned arrived = 0;
+    unsigned generation = 0;
+    auto barrier = [&](){
+        std::unique_lock<std::mutex> lock(m);
+        unsigned gen = generation;
+        if(++arrived == threads){
+            arrived = 0;
+            ++generation;
+            cv.notify_all();
+        }
+        else cv.wait(lock, [&]{ return gen != generation; });
+    };
+
+    auto worker = [&](unsigned id){
+        for(int lvl = deepest; lvl > sharedTop; --lvl){
+            int first = (1 << lvl) - 1;
+            int end = std::min(last, (2 << lvl) - 2) + 1;
+            long long width = end - first;
+            int lo = first + static_cast<int>(width * id / threads);
+            int hi = first + static_cast<int>(width * (id + 1) / threads);
+            for(int i = hi - 1; i >= lo; --i) heapify(i, size_);
+            barrier();
+        }
+    };
+
+    std::vector<std::thread> pool;
+    pool.reserve(threads - 1);
+    for(unsigned id = 1; id < threads; ++id) pool.emplace_back(worker, id);
+    worker(0);
+    for(auto& t : pool) t.join();
+
+    for(int i = std::min(last, (2 << sharedTop) - 2); i >= 0; --i) heapify(i, size_);
+}
+
 template<typename T>
 int binaryHeapMax<T>::getLeft(int i) const{ 
     int index = i * 2 + 1;
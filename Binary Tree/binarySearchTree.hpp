@@ -9,24 +9,52 @@
 #include <initializer_list>
 #include <stdexcept>
 #include <queue>
+#include <iterator>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <cstdint>
+#include "nodePool.hpp"
+#include "treeFile.hpp"
 
 template<typename T>
 struct node {
     T val;
     node<T>* left;
     node<T>* right;
+    node<T>* parent;
 
     node(const T& val_ = T{}, node<T>* left_ = nullptr, node<T>* right_ = nullptr)
-        : val(val_), left(left_), right(right_) {}
+        : val(val_), left(left_), right(right_), parent(nullptr) {}
 };
 
-template <typename T>
+// Balancing policies for binarySearchTree.
+//
+// noBalance keeps the plain insertion-order shape.
+//
+// treapBalance keeps the tree heap-ordered on a pseudo-random priority
+// derived from each node's address, so its shape is that of a random BST
+// whatever the insertion order: expected depth O(log n) and fewer than two
+// rotations per insert or remove on average. The priority is recomputed
+// from the address, so nodes carry no extra field.
+struct noBalance {};
+struct treapBalance {};
+
+template <typename T, typename Balance = noBalance>
 class binarySearchTree {
+    static constexpr bool treap = std::is_same<Balance, treapBalance>::value;
+
     node<T>* root;
     int size_;
-
-    node<T>* insert_(node<T>* tmp, const T& val);
-    node<T>* remove_(node<T>* tmp, const T& val);
+    std::shared_ptr<nodePool<node<T>>> pool_;
+
+    bool insert_(const T& val);
+    bool remove_(const T& val);
+    static uint64_t priority_(const node<T>* tmp);
+    node<T>** linkOf_(node<T>* tmp);
+    void rotateUp_(node<T>* tmp);
+    node<T>* build_(const T* keys, unsigned char* block, size_t lo, size_t hi, node<T>* parent);
+    node<T>* buildTreap_(const T* keys, unsigned char* block, size_t n);
     node<T>* search_(node<T>* tmp, const T& val) const;
     node<T>* successor_(node<T>* tmp) const;
     node<T>* predecessor_(node<T>* tmp) const ;
@@ -36,8 +64,16 @@ class binarySearchTree {
     void clear_(node<T>* tmp);
 
 public:
-    binarySearchTree() noexcept : root(nullptr), size_(0) {}
+    using pool_type = nodePool<node<T>>;
+
+    binarySearchTree() : root(nullptr), size_(0), pool_(std::make_shared<pool_type>()) {}
+    explicit binarySearchTree(std::shared_ptr<pool_type> pool) : root(nullptr), size_(0), pool_(std::move(pool)) {}
+    binarySearchTree(binarySearchTree&& other);
+    binarySearchTree& operator=(binarySearchTree&& other);
     ~binarySearchTree() { clear(); }
+
+    void save(std::ostream& os) const;
+    static binarySearchTree load(std::istream& is);
     void insert(const T& val); 
     void remove(const T& val);
     bool search(const T& val) const;
@@ -45,138 +81,380 @@ public:
     int getHeight(){ return getHeight_(root); }
     int size() const { return size_; }
     bool empty() const { return size_ == 0; }
+    std::shared_ptr<pool_type> pool() const { return pool_; }
+    size_t memoryUsage() const { return pool_->memoryUsage(); }
     void inOrderDisplay() const;
     void display() const;
+
+    class iterator {
+        node<T>* cur;
+        const binarySearchTree* tree;
+        friend class binarySearchTree;
+        iterator(node<T>* cur_, const binarySearchTree* tree_) : cur(cur_), tree(tree_) {}
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T*;
+        using reference = const T&;
+
+        iterator() : cur(nullptr), tree(nullptr) {}
+        reference operator*() const { return cur->val; }
+        pointer operator->() const { return &cur->val; }
+        iterator& operator++() { cur = tree->successor_(cur); return *this; }
+        iterator operator++(int) { iterator tmp = *this; ++*this; return tmp; }
+        iterator& operator--() { cur = cur ? tree->predecessor_(cur) : tree->getMax_(tree->root); return *this; }
+        iterator operator--(int) { iterator tmp = *this; --*this; return tmp; }
+        bool operator==(const iterator& other) const { return cur == other.cur; }
+        bool operator!=(const iterator& other) const { return cur != other.cur; }
+    };
+    using const_iterator = iterator;
+
+    iterator begin() const { return iterator(getMin_(root), this); }
+    iterator end() const { return iterator(nullptr, this); }
+    iterator lower_bound(const T& val) const;
+    iterator upper_bound(const T& val) const;
+    std::pair<iterator, iterator> equal_range(const T& val) const;
+    template<typename Fn>
+    void for_each_in_range(const T& lo, const T& hi, Fn fn) const;
 };
 
-template<typename T>
-void binarySearchTree<T>::insert(const T& val){
-    root = insert_(root, val);
-    ++size_;
+template<typename T, typename Balance>
+binarySearchTree<T, Balance>::binarySearchTree(binarySearchTree&& other)
+    : root(other.root), size_(other.size_), pool_(std::move(other.pool_)){
+    other.root = nullptr;
+    other.size_ = 0;
+    other.pool_ = std::make_shared<pool_type>();
 }
 
-template<typename T>
-node<T>* binarySearchTree<T>::  insert_(node<T>* tmp, const T& val){
-    if(tmp == nullptr) return new node<T>(val);
-    if(val < tmp->val) tmp->left = insert_(tmp->left, val);
-    else if(val > tmp->val) tmp->right = insert_(tmp->right, val);
-    return tmp;
+template<typename T, typename Balance>
+binarySearchTree<T, Balance>& binarySearchTree<T, Balance>::operator=(binarySearchTree&& other){
+    if(this != &other){
+        clear();
+        root = other.root;
+        size_ = other.size_;
+        std::swap(pool_, other.pool_);
+        other.root = nullptr;
+        other.size_ = 0;
+    }
+    return *this;
 }
 
-template<typename T>
-void binarySearchTree<T>::remove(const T& val){
-    if(search(val)){
-        root = remove_(root, val);
-        --size_;
+// Same file format as avl::save, so the two trees can load each other's
+// files.
+template<typename T, typename Balance>
+void binarySearchTree<T, Balance>::save(std::ostream& os) const{
+    writeTreeHeader<T>(os, static_cast<uint64_t>(size_), false);
+    const size_t chunk = 4096;
+    std::vector<T> keys;
+    keys.reserve(std::min(static_cast<size_t>(size_), chunk));
+    for(const T& val : *this){
+        keys.push_back(val);
+        if(keys.size() == chunk){
+            writeTreeBlock(os, keys.data(), keys.size());
+            keys.clear();
+        }
+    }
+    writeTreeBlock(os, keys.data(), keys.size());
+    if(!os){
+        throw std::runtime_error("Failed to write tree file");
     }
 }
 
-template<typename T>
-node<T>* binarySearchTree<T>::remove_(node<T>* tmp, const T& val){
-    if(!tmp) return nullptr;
-    if(val < tmp->val) tmp->left = remove_(tmp->left, val);
-    else if(val > tmp->val) tmp->right = remove_(tmp->right, val);
-    else{
-        node<T>* temp{};
-        if(!tmp->left){
-            temp = tmp->right;
-            delete tmp;
-            return temp;
+// O(n) reload. Without balancing the result is perfectly balanced; a treap
+// is rebuilt as the Cartesian tree of its node priorities so the heap order
+// holds. This tree stores each key once, so equal keys from a plain avl
+// file are folded and the multiplicities of a counted one are skipped.
+template<typename T, typename Balance>
+binarySearchTree<T, Balance> binarySearchTree<T, Balance>::load(std::istream& is){
+    treeFileHeader header = readTreeHeader<T>(is);
+    std::vector<T> keys;
+    readTreeKeys(is, header, keys, nullptr);
+    keys.erase(std::unique(keys.begin(), keys.end(), [](const T& a, const T& b){ return !(a < b); }),
+               keys.end());
+    size_t n = keys.size();
+    binarySearchTree<T, Balance> tree;
+    if(n == 0) return tree;
+    auto* block = static_cast<unsigned char*>(tree.pool_->allocateBlock(n));
+    if constexpr (treap) tree.root = tree.buildTreap_(keys.data(), block, n);
+    else tree.root = tree.build_(keys.data(), block, 0, n, nullptr);
+    tree.size_ = static_cast<int>(n);
+    return tree;
+}
+
+template<typename T, typename Balance>
+node<T>* binarySearchTree<T, Balance>::build_(const T* keys, unsigned char* block, size_t lo, size_t hi, node<T>* parent){
+    if(lo >= hi) return nullptr;
+    size_t mid = lo + (hi - lo) / 2;
+    node<T>* tmp = new (block + mid * pool_type::stride) node<T>(keys[mid]);
+    tmp->parent = parent;
+    tmp->left = build_(keys, block, lo, mid, tmp);
+    tmp->right = build_(keys, block, mid + 1, hi, tmp);
+    return tmp;
+}
+
+// Nodes are placed in key order, then linked in one left-to-right pass
+// that keeps the right spine on a stack.
+template<typename T, typename Balance>
+node<T>* binarySearchTree<T, Balance>::buildTreap_(const T* keys, unsigned char* block, size_t n){
+    std::vector<node<T>*> spine;
+    for(size_t i = 0; i < n; ++i){
+        node<T>* tmp = new (block + i * pool_type::stride) node<T>(keys[i]);
+        node<T>* last = nullptr;
+        while(!spine.empty() && priority_(spine.back()) < priority_(tmp)){
+            last = spine.back();
+            spine.pop_back();
         }
-        if(!tmp->right){
-            temp = tmp->left;
-            delete tmp;
-            return temp;
+        tmp->left = last;
+        if(last) last->parent = tmp;
+        if(!spine.empty()){
+            spine.back()->right = tmp;
+            tmp->parent = spine.back();
         }
-        temp = successor_(tmp);
-        tmp->val = temp->val;
-        tmp->right = remove_(tmp->right, temp->val);
+        spine.push_back(tmp);
     }
-    return tmp;
+    spine.front()->parent = nullptr;
+    return spine.front();
 }
 
-template<typename T>
-bool binarySearchTree<T>::search(const T& val) const{
+template<typename T, typename Balance>
+void binarySearchTree<T, Balance>::insert(const T& val){
+    if(insert_(val)) ++size_;
+}
+
+// All walks below are loops over the address of the current link, so a
+// degenerate (list-shaped) tree costs time but never stack depth.
+template<typename T, typename Balance>
+bool binarySearchTree<T, Balance>::insert_(const T& val){
+    node<T>** link = &root;
+    node<T>* parent = nullptr;
+    while(*link){
+        parent = *link;
+        if(val < (*link)->val) link = &(*link)->left;
+        else if(val > (*link)->val) link = &(*link)->right;
+        else return false;
+    }
+    node<T>* fresh = pool_->create(val);
+    fresh->parent = parent;
+    *link = fresh;
+    if constexpr (treap){
+        while(fresh->parent && priority_(fresh->parent) < priority_(fresh)) rotateUp_(fresh);
+    }
+    return true;
+}
+
+template<typename T, typename Balance>
+void binarySearchTree<T, Balance>::remove(const T& val){
+    if(remove_(val)) --size_;
+}
+
+template<typename T, typename Balance>
+bool binarySearchTree<T, Balance>::remove_(const T& val){
+    node<T>** link = &root;
+    while(*link){
+        if(val < (*link)->val) link = &(*link)->left;
+        else if(val > (*link)->val) link = &(*link)->right;
+        else break;
+    }
+    if(!*link) return false;
+
+    node<T>* target = *link;
+    if constexpr (treap){
+        // Rotate the target down below its higher-priority child until it
+        // has at most one child; the heap order holds everywhere else.
+        while(target->left && target->right){
+            rotateUp_(priority_(target->left) > priority_(target->right) ? target->left : target->right);
+        }
+        link = linkOf_(target);
+    }
+    else if(target->left && target->right){
+        link = &target->right;
+        while((*link)->left) link = &(*link)->left;
+        target->val = (*link)->val;
+        target = *link;
+    }
+    node<T>* child = target->left ? target->left : target->right;
+    if(child) child->parent = target->parent;
+    *link = child;
+    pool_->destroy(target);
+    return true;
+}
+
+// splitmix64 finalizer over the node address.
+template<typename T, typename Balance>
+uint64_t binarySearchTree<T, Balance>::priority_(const node<T>* tmp){
+    uint64_t x = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(tmp));
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+// The link in the parent (or root) that points at tmp.
+template<typename T, typename Balance>
+node<T>** binarySearchTree<T, Balance>::linkOf_(node<T>* tmp){
+    if(!tmp->parent) return &root;
+    return tmp->parent->left == tmp ? &tmp->parent->left : &tmp->parent->right;
+}
+
+// Single rotation that lifts tmp above its parent.
+template<typename T, typename Balance>
+void binarySearchTree<T, Balance>::rotateUp_(node<T>* tmp){
+    node<T>* parent = tmp->parent;
+    node<T>** link = linkOf_(parent);
+    if(parent->left == tmp){
+        parent->left = tmp->right;
+        if(tmp->right) tmp->right->parent = parent;
+        tmp->right = parent;
+    }
+    else{
+        parent->right = tmp->left;
+        if(tmp->left) tmp->left->parent = parent;
+        tmp->left = parent;
+    }
+    tmp->parent = parent->parent;
+    parent->parent = tmp;
+    *link = tmp;
+}
+
+template<typename T, typename Balance>
+bool binarySearchTree<T, Balance>::search(const T& val) const{
     return static_cast<bool>(search_(root, val));
 }
 
-template<typename T>
-node<T>* binarySearchTree<T>::search_(node<T>* tmp, const T& val) const{
-    if (tmp == nullptr) return nullptr;
-    if (tmp->val == val) return tmp;
-    if (tmp->val < val) return search_(tmp->right, val);  
-    else return search_(tmp->left, val);
+template<typename T, typename Balance>
+node<T>* binarySearchTree<T, Balance>::search_(node<T>* tmp, const T& val) const{
+    while(tmp && !(tmp->val == val)){
+        tmp = (tmp->val < val) ? tmp->right : tmp->left;
+    }
+    return tmp;
 }
 
-template<typename T>
-node<T>* binarySearchTree<T>::getMin_(node<T>* tmp) const{
+template<typename T, typename Balance>
+node<T>* binarySearchTree<T, Balance>::getMin_(node<T>* tmp) const{
     if (!tmp) return nullptr;             
-    if (tmp->left == nullptr) return tmp;                     
-    return getMin_(tmp->left);           
+    while(tmp->left) tmp = tmp->left;
+    return tmp;
 }
 
-template<typename T>
-node<T>* binarySearchTree<T>::getMax_(node<T>* tmp) const{
+template<typename T, typename Balance>
+node<T>* binarySearchTree<T, Balance>::getMax_(node<T>* tmp) const{
     if (!tmp) return nullptr;             
-    if (tmp->right == nullptr) return tmp;                     
-    return getMax_(tmp->right);           
+    while(tmp->right) tmp = tmp->right;
+    return tmp;
 }
 
-template<typename T>
-int binarySearchTree<T>::getHeight_(node<T>* tmp) const{
-    if(!tmp) return -1;
-    return std::max(getHeight_(tmp->left), getHeight_(tmp->right)) + 1;
+template<typename T, typename Balance>
+int binarySearchTree<T, Balance>::getHeight_(node<T>* tmp) const{
+    int height = -1;
+    std::queue<node<T>*> q;
+    if(tmp) q.push(tmp);
+    while(!q.empty()){
+        ++height;
+        for(size_t count = q.size(); count > 0; --count){
+            node<T>* cur = q.front();
+            q.pop();
+            if(cur->left) q.push(cur->left);
+            if(cur->right) q.push(cur->right);
+        }
+    }
+    return height;
 }
 
-template<typename T>
-void binarySearchTree<T>::clear() {
-    clear_(root);
+template<typename T, typename Balance>
+void binarySearchTree<T, Balance>::clear() {
+    // A pool owned by this tree alone holds nothing else, so trivially
+    // destructible nodes can be dropped with it in one step.
+    if(std::is_trivially_destructible<T>::value && pool_.use_count() == 1) pool_->release();
+    else clear_(root);
     size_ = 0;
     root = nullptr;
 }
 
-template<typename T>
-void binarySearchTree<T>::clear_(node<T>* tmp) {
-    if(!tmp) return;
-    clear_(tmp->left);
-    clear_(tmp->right);
-    delete tmp;
+// Rotates left children up until the current node has none, then frees it
+// and continues to the right; O(n) time with no stack.
+template<typename T, typename Balance>
+void binarySearchTree<T, Balance>::clear_(node<T>* tmp) {
+    while(tmp){
+        if(tmp->left){
+            node<T>* left = tmp->left;
+            tmp->left = left->right;
+            left->right = tmp;
+            tmp = left;
+        }
+        else{
+            node<T>* right = tmp->right;
+            pool_->destroy(tmp);
+            tmp = right;
+        }
+    }
 }
 
-template<typename T>
-node<T>* binarySearchTree<T>::successor_(node<T>* tmp) const{
+template<typename T, typename Balance>
+node<T>* binarySearchTree<T, Balance>::successor_(node<T>* tmp) const{
     if(!tmp) return nullptr;
     if(tmp->right) return getMin_(tmp->right);
-    node<T>*prev = nullptr;
-    node<T>* ancestor = root;
-    while(ancestor != tmp){
-        if(ancestor->val > tmp->val){
-            prev = ancestor;
-            ancestor = ancestor->left;
-        }
-        else ancestor = ancestor->right;
-    }
-    return prev;
+    while(tmp->parent && tmp->parent->right == tmp) tmp = tmp->parent;
+    return tmp->parent;
 }
 
-template<typename T>
-node<T>* binarySearchTree<T>::predecessor_(node<T>* tmp) const{
+template<typename T, typename Balance>
+node<T>* binarySearchTree<T, Balance>::predecessor_(node<T>* tmp) const{
     if(!tmp) return nullptr;
     if(tmp->left) return getMax_(tmp->left);
-    node<T>* prev = nullptr;
-    node<T>* ancestor = root;
-    while(ancestor != tmp){
-        if(ancestor->val < tmp->val){
-            prev = ancestor;
-            ancestor = ancestor->right;
+    while(tmp->parent && tmp->parent->left == tmp) tmp = tmp->parent;
+    return tmp->parent;
+}
+
+// First key not less than val.
+template<typename T, typename Balance>
+typename binarySearchTree<T, Balance>::iterator binarySearchTree<T, Balance>::lower_bound(const T& val) const{
+    node<T>* result = nullptr;
+    node<T>* tmp = root;
+    while(tmp){
+        if(tmp->val < val) tmp = tmp->right;
+        else{
+            result = tmp;
+            tmp = tmp->left;
         }
-        else ancestor = ancestor->left;
     }
-    return prev;
+    return iterator(result, this);
 }
 
-template<typename T>
-void binarySearchTree<T>::display() const {
+// First key greater than val.
+template<typename T, typename Balance>
+typename binarySearchTree<T, Balance>::iterator binarySearchTree<T, Balance>::upper_bound(const T& val) const{
+    node<T>* result = nullptr;
+    node<T>* tmp = root;
+    while(tmp){
+        if(val < tmp->val){
+            result = tmp;
+            tmp = tmp->left;
+        }
+        else tmp = tmp->right;
+    }
+    return iterator(result, this);
+}
+
+template<typename T, typename Balance>
+std::pair<typename binarySearchTree<T, Balance>::iterator, typename binarySearchTree<T, Balance>::iterator> binarySearchTree<T, Balance>::equal_range(const T& val) const{
+    return {lower_bound(val), upper_bound(val)};
+}
+
+// Calls fn on every key in [lo, hi] in order: one descent to lo, then
+// successor steps that touch O(k) nodes in total.
+template<typename T, typename Balance>
+template<typename Fn>
+void binarySearchTree<T, Balance>::for_each_in_range(const T& lo, const T& hi, Fn fn) const{
+    for(node<T>* tmp = lower_bound(lo).cur; tmp && !(hi < tmp->val); tmp = successor_(tmp)){
+        fn(tmp->val);
+    }
+}
+
+template<typename T, typename Balance>
+void binarySearchTree<T, Balance>::display() const {
     if (empty()) {
         std::cout << "Tree empty" << std::endl;
         return;
@@ -230,15 +508,11 @@ void binarySearchTree<T>::display() const {
 }
 
 
-template<typename T>
-void binarySearchTree<T>::inOrderDisplay() const {
-    std::function<void(node<T>*)> inOrder = [&](node<T>* cur) {
-        if (!cur) return;
-        inOrder(cur->left);
-        std::cout << cur->val << " ";
-        inOrder(cur->right);
-    };
-    inOrder(root);
+template<typename T, typename Balance>
+void binarySearchTree<T, Balance>::inOrderDisplay() const {
+    for(const T& val : *this){
+        std::cout << val << " ";
+    }
     std::cout << std::endl;
 }
 
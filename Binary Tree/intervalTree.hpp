@@ -0,0 +1,266 @@
+#ifndef INTERVAL_TREE_HPP
+#define INTERVAL_TREE_HPP
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <cstdlib>
+#include "nodePool.hpp"
+
+template<typename T>
+struct intervalNode {
+    T lo;
+    T hi;
+    T max;      // largest hi in this subtree
+    intervalNode<T>* left;
+    intervalNode<T>* right;
+    int height;
+
+    intervalNode(const T& lo_, const T& hi_)
+        : lo(lo_), hi(hi_), max(hi_), left(nullptr), right(nullptr), height(0) {}
+};
+
+// AVL tree of closed intervals [lo, hi] ordered by (lo, hi). Every node also
+// keeps the largest endpoint of its subtree, refreshed by update_ whenever a
+// rotation or an insert/remove changes the subtree below it. A subtree whose
+// max is below the query start cannot overlap and is skipped. That pruning
+// bounds a query reporting k intervals by O(min(n, k log(n/k) + log n)):
+// hits that are adjacent in (lo, hi) order share one path, while scattered
+// hits can each cost a path of their own. overlaps() is a single O(log n)
+// walk.
+template<typename T>
+class intervalTree {
+    intervalNode<T>* root;
+    int size_;
+    nodePool<intervalNode<T>> pool_;
+
+    static bool less_(const T& alo, const T& ahi, const intervalNode<T>* b){
+        return alo < b->lo || (!(b->lo < alo) && ahi < b->hi);
+    }
+    intervalNode<T>* insert_(intervalNode<T>* tmp, const T& lo, const T& hi, bool& added);
+    intervalNode<T>* remove_(intervalNode<T>* tmp, const T& lo, const T& hi, bool& removed);
+    intervalNode<T>* removeMin_(intervalNode<T>* tmp, intervalNode<T>*& min);
+    intervalNode<T>* rotate_(intervalNode<T>* tmp);
+    intervalNode<T>* rightRotation_(intervalNode<T>* tmp);
+    intervalNode<T>* leftRotation_(intervalNode<T>* tmp);
+    int balanceFactor_(intervalNode<T>* tmp) const;
+    int getHeight_(intervalNode<T>* tmp) const { return tmp ? tmp->height : -1; }
+    void update_(intervalNode<T>* tmp);
+    void clear_(intervalNode<T>* tmp);
+    template<typename Fn>
+    void overlapping_(intervalNode<T>* tmp, const T& a, const T& b, Fn& fn) const;
+    template<typename Fn>
+    void inOrder_(intervalNode<T>* tmp, Fn& fn) const;
+
+public:
+    intervalTree() : root(nullptr), size_(0) {}
+    intervalTree(const intervalTree&) = delete;
+    intervalTree& operator=(const intervalTree&) = delete;
+    ~intervalTree() { clear(); }
+
+    bool insert(const T& lo, const T& hi);
+    bool remove(const T& lo, const T& hi);
+    bool search(const T& lo, const T& hi) const;
+    template<typename Fn>
+    void overlapping(const T& a, const T& b, Fn fn) const;
+    template<typename Fn>
+    void stabbing(const T& x, Fn fn) const { overlapping(x, x, fn); }
+    bool overlaps(const T& a, const T& b) const;
+    void clear();
+    int getHeight() const { return getHeight_(root); }
+    int size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    void display() const;
+};
+
+template<typename T>
+void intervalTree<T>::update_(intervalNode<T>* tmp){
+    tmp->height = std::max(getHeight_(tmp->left), getHeight_(tmp->right)) + 1;
+    tmp->max = tmp->hi;
+    if(tmp->left && tmp->max < tmp->left->max) tmp->max = tmp->left->max;
+    if(tmp->right && tmp->max < tmp->right->max) tmp->max = tmp->right->max;
+}
+
+template<typename T>
+int intervalTree<T>::balanceFactor_(intervalNode<T>* tmp) const{
+    if(!tmp) return 0;
+    return getHeight_(tmp->left) - getHeight_(tmp->right);
+}
+
+template<typename T>
+intervalNode<T>* intervalTree<T>::rightRotation_(intervalNode<T>* tmp){
+    intervalNode<T>* x = tmp->left;
+    tmp->left = x->right;
+    x->right = tmp;
+    update_(tmp);
+    update_(x);
+    return x;
+}
+
+template<typename T>
+intervalNode<T>* intervalTree<T>::leftRotation_(intervalNode<T>* tmp){
+    intervalNode<T>* y = tmp->right;
+    tmp->right = y->left;
+    y->left = tmp;
+    update_(tmp);
+    update_(y);
+    return y;
+}
+
+template<typename T>
+intervalNode<T>* intervalTree<T>::rotate_(intervalNode<T>* tmp){
+    if(!tmp) return nullptr;
+    update_(tmp);
+    int balance = balanceFactor_(tmp);
+    if(std::abs(balance) <= 1) return tmp;
+    if(balance > 1){
+        if(balanceFactor_(tmp->left) < 0) tmp->left = leftRotation_(tmp->left);
+        return rightRotation_(tmp);
+    }
+    if(balanceFactor_(tmp->right) > 0) tmp->right = rightRotation_(tmp->right);
+    return leftRotation_(tmp);
+}
+
+template<typename T>
+intervalNode<T>* intervalTree<T>::insert_(intervalNode<T>* tmp, const T& lo, const T& hi, bool& added){
+    if(!tmp){
+        added = true;
+        return pool_.create(lo, hi);
+    }
+    if(less_(lo, hi, tmp)) tmp->left = insert_(tmp->left, lo, hi, added);
+    else if(tmp->lo < lo || tmp->hi < hi) tmp->right = insert_(tmp->right, lo, hi, added);
+    else return tmp;
+    return rotate_(tmp);
+}
+
+template<typename T>
+intervalNode<T>* intervalTree<T>::removeMin_(intervalNode<T>* tmp, intervalNode<T>*& min){
+    if(!tmp->left){
+        min = tmp;
+        return tmp->right;
+    }
+    tmp->left = removeMin_(tmp->left, min);
+    return rotate_(tmp);
+}
+
+template<typename T>
+intervalNode<T>* intervalTree<T>::remove_(intervalNode<T>* tmp, const T& lo, const T& hi, bool& removed){
+    if(!tmp) return nullptr;
+    if(less_(lo, hi, tmp)) tmp->left = remove_(tmp->left, lo, hi, removed);
+    else if(tmp->lo < lo || tmp->hi < hi) tmp->right = remove_(tmp->right, lo, hi, removed);
+    else{
+        removed = true;
+        intervalNode<T>* left = tmp->left;
+        intervalNode<T>* right = tmp->right;
+        pool_.destroy(tmp);
+        if(!left) return right;
+        if(!right) return left;
+        intervalNode<T>* min = nullptr;
+        right = removeMin_(right, min);
+        min->left = left;
+        min->right = right;
+        return rotate_(min);
+    }
+    return rotate_(tmp);
+}
+
+template<typename T>
+bool intervalTree<T>::insert(const T& lo, const T& hi){
+    if(hi < lo){
+        throw std::invalid_argument("Interval end is before its start");
+    }
+    bool added = false;
+    root = insert_(root, lo, hi, added);
+    if(added) ++size_;
+    return added;
+}
+
+template<typename T>
+bool intervalTree<T>::remove(const T& lo, const T& hi){
+    bool removed = false;
+    root = remove_(root, lo, hi, removed);
+    if(removed) --size_;
+    return removed;
+}
+
+template<typename T>
+bool intervalTree<T>::search(const T& lo, const T& hi) const{
+    intervalNode<T>* tmp = root;
+    while(tmp){
+        if(less_(lo, hi, tmp)) tmp = tmp->left;
+        else if(tmp->lo < lo || tmp->hi < hi) tmp = tmp->right;
+        else return true;
+    }
+    return false;
+}
+
+// Left subtrees are pruned by their max endpoint, right subtrees by the
+// start of the current node: everything to the right starts at or after it.
+template<typename T>
+template<typename Fn>
+void intervalTree<T>::overlapping_(intervalNode<T>* tmp, const T& a, const T& b, Fn& fn) const{
+    if(!tmp || tmp->max < a) return;
+    overlapping_(tmp->left, a, b, fn);
+    if(b < tmp->lo) return;
+    if(!(tmp->hi < a)) fn(tmp->lo, tmp->hi);
+    overlapping_(tmp->right, a, b, fn);
+}
+
+// Calls fn(lo, hi) for every stored interval intersecting [a, b], in order.
+template<typename T>
+template<typename Fn>
+void intervalTree<T>::overlapping(const T& a, const T& b, Fn fn) const{
+    if(b < a){
+        throw std::invalid_argument("Interval end is before its start");
+    }
+    overlapping_(root, a, b, fn);
+}
+
+// Whether any interval intersects [a, b]; a single root-to-leaf walk.
+template<typename T>
+bool intervalTree<T>::overlaps(const T& a, const T& b) const{
+    intervalNode<T>* tmp = root;
+    while(tmp){
+        if(!(tmp->hi < a) && !(b < tmp->lo)) return true;
+        if(tmp->left && !(tmp->left->max < a)) tmp = tmp->left;
+        else tmp = tmp->right;
+    }
+    return false;
+}
+
+template<typename T>
+void intervalTree<T>::clear(){
+    clear_(root);
+    root = nullptr;
+    size_ = 0;
+}
+
+template<typename T>
+void intervalTree<T>::clear_(intervalNode<T>* tmp){
+    if(!tmp) return;
+    clear_(tmp->left);
+    clear_(tmp->right);
+    pool_.destroy(tmp);
+}
+
+template<typename T>
+template<typename Fn>
+void intervalTree<T>::inOrder_(intervalNode<T>* tmp, Fn& fn) const{
+    if(!tmp) return;
+    inOrder_(tmp->left, fn);
+    fn(tmp);
+    inOrder_(tmp->right, fn);
+}
+
+template<typename T>
+void intervalTree<T>::display() const{
+    if(empty()){
+        std::cout << "Tree empty" << std::endl;
+        return;
+    }
+    auto print = [](intervalNode<T>* tmp){ std::cout << "[" << tmp->lo << ", " << tmp->hi << "] "; };
+    inOrder_(root, print);
+    std::cout << std::endl;
+}
+
+#endif
@@ -0,0 +1,147 @@
+#ifndef MULTI_QUEUE_HPP
+#define MULTI_QUEUE_HPP
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include "binaryHeapMax.hpp"
+
+// Concurrent max-priority queue built from binaryHeapMax lanes.
+//
+// Relaxed mode (default) keeps c * threads heaps, each behind its own lock.
+// push goes to a random lane, try_pop locks two random lanes and pops the
+// larger top. The result is not always the global maximum, but its expected
+// rank is O(number of lanes) and operations rarely contend.
+//
+// Strict mode (strict = true) is a single heap behind one mutex and always
+// returns the global maximum; it is the baseline the relaxed mode replaces.
+template<typename T, bool strict = false>
+class multiQueue {
+    struct alignas(64) lane {
+        std::mutex lock;
+        std::atomic<size_t> size{0};
+        binaryHeapMax<T> heap;
+    };
+
+    std::unique_ptr<lane[]> lanes;
+    size_t laneCount;
+    std::atomic<size_t> size_{0};
+
+    static uint64_t random_();
+    size_t pick_() const { return static_cast<size_t>(random_() % laneCount); }
+    bool popFrom_(lane& l, T& out);
+    bool sweep_(T& out);
+
+public:
+    explicit multiQueue(unsigned threads = std::thread::hardware_concurrency(), unsigned c = 2);
+    multiQueue(const multiQueue&) = delete;
+    multiQueue& operator=(const multiQueue&) = delete;
+
+    void push(const T& value);
+    bool try_pop(T& out);
+    size_t size() const { return size_.load(std::memory_order_relaxed); }
+    bool empty() const { return size() == 0; }
+    size_t lanesCount() const { return laneCount; }
+};
+
+template<typename T, bool strict>
+multiQueue<T, strict>::multiQueue(unsigned threads, unsigned c){
+    if(threads == 0) threads = 1;
+    if(c == 0) c = 1;
+    laneCount = strict ? 1 : static_cast<size_t>(threads) * c;
+    lanes.reset(new lane[laneCount]);
+}
+
+template<typename T, bool strict>
+uint64_t multiQueue<T, strict>::random_(){
+    thread_local uint64_t state = 0x9e3779b97f4a7c15ULL ^
+        static_cast<uint64_t>(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+template<typename T, bool strict>
+void multiQueue<T, strict>::push(const T& value){
+    if constexpr (strict){
+        std::lock_guard<std::mutex> guard(lanes[0].lock);
+        lanes[0].heap.push(value);
+        lanes[0].size.fetch_add(1, std::memory_order_relaxed);
+        size_.fetch_add(1, std::memory_order_relaxed);
+    }
+    else{
+        while(true){
+            lane& l = lanes[pick_()];
+            if(!l.lock.try_lock()) continue;
+            l.heap.push(value);
+            l.size.fetch_add(1, std::memory_order_relaxed);
+            size_.fetch_add(1, std::memory_order_relaxed);
+            l.lock.unlock();
+            break;
+        }
+    }
+}
+
+// Caller holds l.lock.
+template<typename T, bool strict>
+bool multiQueue<T, strict>::popFrom_(lane& l, T& out){
+    if(l.heap.empty()) return false;
+    out = l.heap.top();
+    l.heap.pop();
+    l.size.fetch_sub(1, std::memory_order_relaxed);
+    size_.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+}
+
+template<typename T, bool strict>
+bool multiQueue<T, strict>::try_pop(T& out){
+    if constexpr (strict){
+        std::lock_guard<std::mutex> guard(lanes[0].lock);
+        return popFrom_(lanes[0], out);
+    }
+    else{
+        const size_t attempts = 2 * laneCount;
+        for(size_t attempt = 0; attempt < attempts; ++attempt){
+            if(empty()) return false;
+            lane* a = &lanes[pick_()];
+            lane* b = &lanes[pick_()];
+            if(a->size.load(std::memory_order_relaxed) == 0) std::swap(a, b);
+            if(a->size.load(std::memory_order_relaxed) == 0) continue;
+            if(!a->lock.try_lock()) continue;
+            if(a != b && b->size.load(std::memory_order_relaxed) != 0 && b->lock.try_lock()){
+                lane* best = a;
+                if(a->heap.empty() || (!b->heap.empty() && a->heap.top() < b->heap.top())) best = b;
+                bool ok = popFrom_(*best, out);
+                b->lock.unlock();
+                a->lock.unlock();
+                if(ok) return true;
+                continue;
+            }
+            bool ok = popFrom_(*a, out);
+            a->lock.unlock();
+            if(ok) return true;
+        }
+        return sweep_(out);
+    }
+}
+
+// Random probing kept missing; visit every lane so try_pop only fails when
+// the queue really was empty during the sweep.
+template<typename T, bool strict>
+bool multiQueue<T, strict>::sweep_(T& out){
+    size_t first = pick_();
+    for(size_t k = 0; k < laneCount; ++k){
+        lane& l = lanes[(first + k) % laneCount];
+        if(l.size.load(std::memory_order_relaxed) == 0) continue;
+        std::lock_guard<std::mutex> guard(l.lock);
+        if(popFrom_(l, out)) return true;
+    }
+    return false;
+}
+
+#endif
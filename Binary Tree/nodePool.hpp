@@ -0,0 +1,176 @@
+#ifndef NODE_POOL_HPP
+#define NODE_POOL_HPP
+
+#include <vector>
+#include <memory>
+#include <utility>
+#include <cstddef>
+#include <new>
+#include <algorithm>
+
+// Slab allocator for fixed-size tree nodes. Nodes are carved sequentially
+// out of slabs that double in size up to MAX_SLAB nodes, so nodes created
+// one after another are adjacent in memory and carry no per-node allocator
+// header. Freed nodes go on an intrusive free list and are reused first.
+//
+// A pool may be shared by several trees of the same node type (hold it
+// through std::shared_ptr). It is not thread-safe.
+template<typename Node>
+class nodePool {
+    union cell {
+        cell* next;
+        alignas(Node) unsigned char bytes[sizeof(Node)];
+    };
+
+    static constexpr size_t MIN_SLAB = 32;
+    static constexpr size_t MAX_SLAB = 1 << 16;
+
+    std::vector<std::unique_ptr<cell[]>> slabs;
+    size_t slabSize;
+    size_t used;
+    size_t capacity_;
+    size_t live_;
+    cell* freeList;
+    cell* freeTail;     // last cell of freeList, so merge can splice it in O(1)
+
+    void grow();
+public:
+    // Distance in bytes between consecutive nodes of a block.
+    static constexpr size_t stride = sizeof(cell);
+
+    nodePool() noexcept : slabSize(0), used(0), capacity_(0), live_(0), freeList(nullptr), freeTail(nullptr) {}
+    nodePool(const nodePool&) = delete;
+    nodePool& operator=(const nodePool&) = delete;
+
+    void* allocate();
+    void deallocate(void* p) noexcept;
+    template<typename... Args>
+    Node* create(Args&&... args);
+    void destroy(Node* n) noexcept;
+    void reserve(size_t count);
+    void* allocateBlock(size_t count);
+    void merge(nodePool& other);
+    void release() noexcept;
+
+    size_t live() const { return live_; }
+    size_t capacity() const { return capacity_; }
+    size_t memoryUsage() const { return capacity_ * sizeof(cell) + slabs.capacity() * sizeof(slabs[0]); }
+};
+
+template<typename Node>
+void nodePool<Node>::grow(){
+    slabSize = slabSize == 0 ? MIN_SLAB : std::min(slabSize * 2, MAX_SLAB);
+    slabs.emplace_back(new cell[slabSize]);
+    used = 0;
+    capacity_ += slabSize;
+}
+
+template<typename Node>
+void* nodePool<Node>::allocate(){
+    ++live_;
+    if(freeList){
+        cell* c = freeList;
+        freeList = c->next;
+        if(!freeList) freeTail = nullptr;
+        return c;
+    }
+    if(slabs.empty() || used == slabSize) grow();
+    return &slabs.back()[used++];
+}
+
+template<typename Node>
+void nodePool<Node>::deallocate(void* p) noexcept{
+    cell* c = static_cast<cell*>(p);
+    c->next = freeList;
+    if(!freeList) freeTail = c;
+    freeList = c;
+    --live_;
+}
+
+template<typename Node>
+template<typename... Args>
+Node* nodePool<Node>::create(Args&&... args){
+    void* p = allocate();
+    try{
+        return new (p) Node(std::forward<Args>(args)...);
+    }
+    catch(...){
+        deallocate(p);
+        throw;
+    }
+}
+
+template<typename Node>
+void nodePool<Node>::destroy(Node* n) noexcept{
+    if(!n) return;
+    n->~Node();
+    deallocate(n);
+}
+
+// Makes the next `count` allocations come from one contiguous slab.
+template<typename Node>
+void nodePool<Node>::reserve(size_t count){
+    size_t left = slabs.empty() ? 0 : slabSize - used;
+    if(left >= count) return;
+    slabs.emplace_back(new cell[count]);
+    slabSize = count;
+    used = 0;
+    capacity_ += count;
+}
+
+// Hands out storage for `count` adjacent nodes in a dedicated slab; node i
+// lives at offset i * stride and is constructed by the caller. Each of them
+// is later returned with destroy()/deallocate() like any other node.
+template<typename Node>
+void* nodePool<Node>::allocateBlock(size_t count){
+    if(count == 0) return nullptr;
+    cell* block = new cell[count];
+    slabs.emplace_back(block);
+    if(slabs.size() > 1) std::swap(slabs.back(), slabs[slabs.size() - 2]);
+    else{
+        slabSize = count;
+        used = count;
+    }
+    capacity_ += count;
+    live_ += count;
+    return block;
+}
+
+// Takes over every slab of other, with the nodes living in them, in
+// O(number of slabs); nothing is copied and no node moves. Afterwards those
+// nodes are destroyed through this pool and other is empty. The unused
+// tail of other's current slab is kept but no longer handed out.
+template<typename Node>
+void nodePool<Node>::merge(nodePool& other){
+    if(this == &other) return;
+    if(slabs.empty()){
+        slabSize = other.slabSize;
+        used = other.used;
+    }
+    slabs.reserve(slabs.size() + other.slabs.size());
+    auto current = slabs.empty() ? slabs.end() : slabs.end() - 1;
+    slabs.insert(current, std::make_move_iterator(other.slabs.begin()),
+                 std::make_move_iterator(other.slabs.end()));
+    capacity_ += other.capacity_;
+    live_ += other.live_;
+    if(other.freeList){
+        other.freeTail->next = freeList;
+        if(!freeList) freeTail = other.freeTail;
+        freeList = other.freeList;
+    }
+    other.slabs.clear();
+    other.slabSize = other.used = other.capacity_ = other.live_ = 0;
+    other.freeList = other.freeTail = nullptr;
+}
+
+// Drops every slab at once. Nodes still alive are not destroyed, so this is
+// only valid when they are trivially destructible or already destroyed.
+template<typename Node>
+void nodePool<Node>::release() noexcept{
+    slabs.clear();
+    slabs.shrink_to_fit();
+    slabSize = used = capacity_ = live_ = 0;
+    freeList = freeTail = nullptr;
+}
+
+#endif
@@ -0,0 +1,201 @@
+#ifndef PERSISTENT_AVL_HPP
+#define PERSISTENT_AVL_HPP
+
+#include <memory>
+#include <utility>
+#include <iostream>
+#include <algorithm>
+#include <stdexcept>
+
+// Immutable AVL tree. insert and remove leave the tree they are called on
+// untouched and return a new version that copies only the O(log n) nodes on
+// the search path; every other subtree is shared by reference count. A
+// snapshot is therefore a plain copy of the handle, O(1), and it stays valid
+// and unchanged however many versions are derived from it later.
+//
+// Nodes are never mutated after construction, so different threads may read
+// and derive versions concurrently without locks; a node is freed when the
+// last version that reaches it goes away.
+template<typename T>
+class persistentAvl {
+    struct pnode;
+    using link = std::shared_ptr<const pnode>;
+    struct pnode {
+        T val;
+        link left;
+        link right;
+        int height;
+        int size;
+
+        pnode(const T& val_, link left_, link right_)
+            : val(val_), left(std::move(left_)), right(std::move(right_)),
+              height(std::max(getHeight_(left), getHeight_(right)) + 1),
+              size(getSize_(left) + getSize_(right) + 1) {}
+    };
+
+    link root;
+
+    explicit persistentAvl(link root_) : root(std::move(root_)) {}
+
+    static int getHeight_(const link& tmp) { return tmp ? tmp->height : -1; }
+    static int getSize_(const link& tmp) { return tmp ? tmp->size : 0; }
+    static link make_(const T& val, link left, link right);
+    static link balance_(const T& val, link left, link right);
+    static link insert_(const link& tmp, const T& val);
+    static link remove_(const link& tmp, const T& val);
+    static link removeMin_(const link& tmp, const pnode*& min);
+    template<typename Fn>
+    static void inOrder_(const pnode* tmp, Fn& fn);
+
+public:
+    persistentAvl() = default;
+
+    persistentAvl insert(const T& val) const;
+    persistentAvl remove(const T& val) const;
+    bool search(const T& val) const;
+    const T& getMin() const;
+    const T& getMax() const;
+    int getHeight() const { return getHeight_(root); }
+    int size() const { return getSize_(root); }
+    bool empty() const { return !root; }
+    template<typename Fn>
+    void for_each(Fn fn) const { inOrder_(root.get(), fn); }
+    void display() const;
+};
+
+template<typename T>
+typename persistentAvl<T>::link persistentAvl<T>::make_(const T& val, link left, link right){
+    return std::make_shared<const pnode>(val, std::move(left), std::move(right));
+}
+
+// Builds the node (left, val, right) where the heights of left and right
+// differ by at most two, rotating the fresh copies instead of the originals.
+template<typename T>
+typename persistentAvl<T>::link persistentAvl<T>::balance_(const T& val, link left, link right){
+    int hl = getHeight_(left);
+    int hr = getHeight_(right);
+    if(hl > hr + 1){
+        if(getHeight_(left->left) >= getHeight_(left->right)){
+            return make_(left->val, left->left, make_(val, left->right, std::move(right)));
+        }
+        const pnode* lr = left->right.get();
+        return make_(lr->val, make_(left->val, left->left, lr->left), make_(val, lr->right, std::move(right)));
+    }
+    if(hr > hl + 1){
+        if(getHeight_(right->right) >= getHeight_(right->left)){
+            return make_(right->val, make_(val, std::move(left), right->left), right->right);
+        }
+        const pnode* rl = right->left.get();
+        return make_(rl->val, make_(val, std::move(left), rl->left), make_(right->val, rl->right, right->right));
+    }
+    return make_(val, std::move(left), std::move(right));
+}
+
+// Returns tmp itself when val is already present, so no path is copied.
+template<typename T>
+typename persistentAvl<T>::link persistentAvl<T>::insert_(const link& tmp, const T& val){
+    if(!tmp) return make_(val, nullptr, nullptr);
+    if(val < tmp->val){
+        link left = insert_(tmp->left, val);
+        if(left == tmp->left) return tmp;
+        return balance_(tmp->val, std::move(left), tmp->right);
+    }
+    if(tmp->val < val){
+        link right = insert_(tmp->right, val);
+        if(right == tmp->right) return tmp;
+        return balance_(tmp->val, tmp->left, std::move(right));
+    }
+    return tmp;
+}
+
+template<typename T>
+typename persistentAvl<T>::link persistentAvl<T>::removeMin_(const link& tmp, const pnode*& min){
+    if(!tmp->left){
+        min = tmp.get();
+        return tmp->right;
+    }
+    return balance_(tmp->val, removeMin_(tmp->left, min), tmp->right);
+}
+
+// Returns tmp itself when val is absent.
+template<typename T>
+typename persistentAvl<T>::link persistentAvl<T>::remove_(const link& tmp, const T& val){
+    if(!tmp) return tmp;
+    if(val < tmp->val){
+        link left = remove_(tmp->left, val);
+        if(left == tmp->left) return tmp;
+        return balance_(tmp->val, std::move(left), tmp->right);
+    }
+    if(tmp->val < val){
+        link right = remove_(tmp->right, val);
+        if(right == tmp->right) return tmp;
+        return balance_(tmp->val, tmp->left, std::move(right));
+    }
+    if(!tmp->left) return tmp->right;
+    if(!tmp->right) return tmp->left;
+    const pnode* min = nullptr;
+    link right = removeMin_(tmp->right, min);
+    return balance_(min->val, tmp->left, std::move(right));
+}
+
+template<typename T>
+persistentAvl<T> persistentAvl<T>::insert(const T& val) const{
+    return persistentAvl(insert_(root, val));
+}
+
+template<typename T>
+persistentAvl<T> persistentAvl<T>::remove(const T& val) const{
+    return persistentAvl(remove_(root, val));
+}
+
+template<typename T>
+bool persistentAvl<T>::search(const T& val) const{
+    const pnode* tmp = root.get();
+    while(tmp){
+        if(val < tmp->val) tmp = tmp->left.get();
+        else if(tmp->val < val) tmp = tmp->right.get();
+        else return true;
+    }
+    return false;
+}
+
+template<typename T>
+const T& persistentAvl<T>::getMin() const{
+    if(empty()){
+        throw std::out_of_range("Empty tree");
+    }
+    const pnode* tmp = root.get();
+    while(tmp->left) tmp = tmp->left.get();
+    return tmp->val;
+}
+
+template<typename T>
+const T& persistentAvl<T>::getMax() const{
+    if(empty()){
+        throw std::out_of_range("Empty tree");
+    }
+    const pnode* tmp = root.get();
+    while(tmp->right) tmp = tmp->right.get();
+    return tmp->val;
+}
+
+template<typename T>
+template<typename Fn>
+void persistentAvl<T>::inOrder_(const pnode* tmp, Fn& fn){
+    if(!tmp) return;
+    inOrder_(tmp->left.get(), fn);
+    fn(tmp->val);
+    inOrder_(tmp->right.get(), fn);
+}
+
+template<typename T>
+void persistentAvl<T>::display() const{
+    if(empty()){
+        std::cout << "Tree empty" << std::endl;
+        return;
+    }
+    for_each([](const T& val){ std::cout << val << " "; });
+    std::cout << std::endl;
+}
+
+#endif
@@ -0,0 +1,193 @@
+#ifndef SIMD_SEARCH_HPP
+#define SIMD_SEARCH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#if defined(__SSE2__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+// Vectorized search kernels over sorted blocks of arithmetic keys.
+//
+// simdCountLess(keys, n, key) returns how many of the n keys are less than
+// key, which for a sorted block is its lower_bound index;
+// simdCountGreater counts keys greater than key. 32- and 64-bit integers,
+// float and double compare 8/4 keys per AVX2 instruction (4/2 with SSE),
+// chosen at compile time from the target flags; every other type, and
+// every target without SSE2, uses the scalar loop. Floating point keys must
+// not be NaN.
+//
+// simdLowerBound narrows a large sorted range with branch-free binary
+// search and finishes inside a block of at most SIMD_BLOCK keys.
+
+namespace simd_detail {
+
+inline unsigned popcount(unsigned mask){
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<unsigned>(__builtin_popcount(mask));
+#else
+    unsigned count = 0;
+    for(; mask; mask &= mask - 1) ++count;
+    return count;
+#endif
+}
+
+// greater == false counts keys[i] < key, greater == true counts key < keys[i].
+template<bool greater, typename T>
+size_t scalarCount(const T* keys, size_t i, size_t n, const T& key){
+    size_t result = 0;
+    for(; i < n; ++i) result += greater ? (key < keys[i]) : (keys[i] < key);
+    return result;
+}
+
+#if defined(__SSE2__) || defined(__AVX2__)
+
+// Unsigned keys are compared as signed after flipping their top bit.
+template<bool greater, bool isUnsigned, typename T>
+size_t count32(const T* keys, size_t n, const T& key){
+    const int32_t flip = isUnsigned ? INT32_MIN : 0;
+    int32_t k;
+    static_assert(sizeof(T) == sizeof(k), "32-bit kernel");
+    __builtin_memcpy(&k, &key, sizeof(k));
+    k ^= flip;
+    size_t i = 0;
+    size_t result = 0;
+#if defined(__AVX2__)
+    const __m256i k8 = _mm256_set1_epi32(k);
+    const __m256i f8 = _mm256_set1_epi32(flip);
+    for(; i + 8 <= n; i += 8){
+        __m256i v = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i)), f8);
+        __m256i m = greater ? _mm256_cmpgt_epi32(v, k8) : _mm256_cmpgt_epi32(k8, v);
+        result += popcount(static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(m))));
+    }
+#endif
+    const __m128i k4 = _mm_set1_epi32(k);
+    const __m128i f4 = _mm_set1_epi32(flip);
+    for(; i + 4 <= n; i += 4){
+        __m128i v = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + i)), f4);
+        __m128i m = greater ? _mm_cmpgt_epi32(v, k4) : _mm_cmpgt_epi32(k4, v);
+        result += popcount(static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(m))));
+    }
+    return result + scalarCount<greater>(keys, i, n, key);
+}
+
+template<bool greater, bool isUnsigned, typename T>
+size_t count64(const T* keys, size_t n, const T& key){
+    size_t i = 0;
+    size_t result = 0;
+#if defined(__AVX2__) || defined(__SSE4_2__)
+    const int64_t flip = isUnsigned ? INT64_MIN : 0;
+    int64_t k;
+    static_assert(sizeof(T) == sizeof(k), "64-bit kernel");
+    __builtin_memcpy(&k, &key, sizeof(k));
+    k ^= flip;
+#endif
+#if defined(__AVX2__)
+    const __m256i k4 = _mm256_set1_epi64x(k);
+    const __m256i f4 = _mm256_set1_epi64x(flip);
+    for(; i + 4 <= n; i += 4){
+        __m256i v = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i)), f4);
+        __m256i m = greater ? _mm256_cmpgt_epi64(v, k4) : _mm256_cmpgt_epi64(k4, v);
+        result += popcount(static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(m))));
+    }
+#endif
+#if defined(__SSE4_2__)
+    const __m128i k2 = _mm_set1_epi64x(k);
+    const __m128i f2 = _mm_set1_epi64x(flip);
+    for(; i + 2 <= n; i += 2){
+        __m128i v = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + i)), f2);
+        __m128i m = greater ? _mm_cmpgt_epi64(v, k2) : _mm_cmpgt_epi64(k2, v);
+        result += popcount(static_cast<unsigned>(_mm_movemask_pd(_mm_castsi128_pd(m))));
+    }
+#endif
+    return result + scalarCount<greater>(keys, i, n, key);
+}
+
+template<bool greater>
+size_t countFloat(const float* keys, size_t n, float key){
+    size_t i = 0;
+    size_t result = 0;
+#if defined(__AVX2__)
+    const __m256 k8 = _mm256_set1_ps(key);
+    for(; i + 8 <= n; i += 8){
+        __m256 v = _mm256_loadu_ps(keys + i);
+        __m256 m = greater ? _mm256_cmp_ps(k8, v, _CMP_LT_OQ) : _mm256_cmp_ps(v, k8, _CMP_LT_OQ);
+        result += popcount(static_cast<unsigned>(_mm256_movemask_ps(m)));
+    }
+#endif
+    const __m128 k4 = _mm_set1_ps(key);
+    for(; i + 4 <= n; i += 4){
+        __m128 v = _mm_loadu_ps(keys + i);
+        __m128 m = greater ? _mm_cmplt_ps(k4, v) : _mm_cmplt_ps(v, k4);
+        result += popcount(static_cast<unsigned>(_mm_movemask_ps(m)));
+    }
+    return result + scalarCount<greater>(keys, i, n, key);
+}
+
+template<bool greater>
+size_t countDouble(const double* keys, size_t n, double key){
+    size_t i = 0;
+    size_t result = 0;
+#if defined(__AVX2__)
+    const __m256d k4 = _mm256_set1_pd(key);
+    for(; i + 4 <= n; i += 4){
+        __m256d v = _mm256_loadu_pd(keys + i);
+        __m256d m = greater ? _mm256_cmp_pd(k4, v, _CMP_LT_OQ) : _mm256_cmp_pd(v, k4, _CMP_LT_OQ);
+        result += popcount(static_cast<unsigned>(_mm256_movemask_pd(m)));
+    }
+#endif
+    const __m128d k2 = _mm_set1_pd(key);
+    for(; i + 2 <= n; i += 2){
+        __m128d v = _mm_loadu_pd(keys + i);
+        __m128d m = greater ? _mm_cmplt_pd(k2, v) : _mm_cmplt_pd(v, k2);
+        result += popcount(static_cast<unsigned>(_mm_movemask_pd(m)));
+    }
+    return result + scalarCount<greater>(keys, i, n, key);
+}
+
+#endif
+
+template<bool greater, typename T>
+size_t count(const T* keys, size_t n, const T& key){
+#if defined(__SSE2__) || defined(__AVX2__)
+    if constexpr (std::is_same<T, float>::value) return countFloat<greater>(keys, n, key);
+    else if constexpr (std::is_same<T, double>::value) return countDouble<greater>(keys, n, key);
+    else if constexpr (std::is_integral<T>::value && !std::is_same<T, bool>::value && sizeof(T) == 4)
+        return count32<greater, std::is_unsigned<T>::value>(keys, n, key);
+    else if constexpr (std::is_integral<T>::value && !std::is_same<T, bool>::value && sizeof(T) == 8)
+        return count64<greater, std::is_unsigned<T>::value>(keys, n, key);
+    else return scalarCount<greater>(keys, 0, n, key);
+#else
+    return scalarCount<greater>(keys, 0, n, key);
+#endif
+}
+
+}
+
+template<typename T>
+size_t simdCountLess(const T* keys, size_t n, const T& key){
+    return simd_detail::count<false>(keys, n, key);
+}
+
+template<typename T>
+size_t simdCountGreater(const T* keys, size_t n, const T& key){
+    return simd_detail::count<true>(keys, n, key);
+}
+
+constexpr size_t SIMD_BLOCK = 64;
+
+template<typename T>
+const T* simdLowerBound(const T* first, const T* last, const T& key){
+    const T* base = first;
+    size_t n = static_cast<size_t>(last - first);
+    while(n > SIMD_BLOCK){
+        size_t half = n / 2;
+        base = (base[half] < key) ? base + half : base;
+        n -= half;
+    }
+    return base + simdCountLess(base, n, key);
+}
+
+#endif
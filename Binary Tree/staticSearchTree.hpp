@@ -0,0 +1,145 @@
+#ifndef STATIC_SEARCH_TREE_HPP
+#define STATIC_SEARCH_TREE_HPP
+
+#include <vector>
+#include <iterator>
+#include <iostream>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+#include <new>
+
+// Allocates on cache line boundaries, so slot offsets map to fixed lines.
+template<typename U>
+struct cacheLineAllocator {
+    using value_type = U;
+    static constexpr std::size_t LINE = 64;
+
+    cacheLineAllocator() = default;
+    template<typename V>
+    cacheLineAllocator(const cacheLineAllocator<V>&) noexcept {}
+
+    U* allocate(std::size_t n){
+        return static_cast<U*>(::operator new(n * sizeof(U), std::align_val_t(LINE)));
+    }
+    void deallocate(U* p, std::size_t) noexcept{
+        ::operator delete(p, std::align_val_t(LINE));
+    }
+    template<typename V>
+    bool operator==(const cacheLineAllocator<V>&) const noexcept { return true; }
+    template<typename V>
+    bool operator!=(const cacheLineAllocator<V>&) const noexcept { return false; }
+};
+
+// Read-only ordered set stored in Eytzinger (BFS) order: the children of
+// slot k are slots 2k and 2k+1, so the first levels of every search share
+// the same few cache lines and no pointers are stored at all. Search is
+// branchless. The 2^d descendants of slot k that sit d levels below it are
+// the adjacent slots [2^d k, 2^d (k + 1)), so with line-aligned storage and
+// 2^d keys per line they fill exactly one line; the search prefetches that
+// line, d = PREFETCH_LEVELS levels ahead (four for 4-byte keys, three for
+// 8-byte keys). For key sizes that do not divide 64 the group may straddle
+// two lines.
+//
+// Build it from a sorted range, or from any ordered container such as avl
+// or binarySearchTree via from().
+template<typename T>
+class staticSearchTree {
+    std::vector<T, cacheLineAllocator<T>> data;    // 1-based, data[0] unused
+    size_t size_;
+
+    static constexpr int prefetchLevels_(){
+        int d = 0;
+        while((size_t(2) << d) * sizeof(T) <= cacheLineAllocator<T>::LINE) ++d;
+        return d;
+    }
+    static constexpr int PREFETCH_LEVELS = prefetchLevels_();
+    static constexpr size_t PREFETCH = size_t(1) << PREFETCH_LEVELS;
+
+    template<typename RandomIt>
+    void fill(RandomIt& it, size_t k);
+    size_t lowerBoundSlot(const T& val) const;
+public:
+    staticSearchTree() : data(1), size_(0) {}
+    template<typename InputIt, typename = std::enable_if_t<std::is_base_of<std::input_iterator_tag,
+             typename std::iterator_traits<InputIt>::iterator_category>::value>>
+    staticSearchTree(InputIt first, InputIt last);
+    template<typename Container>
+    static staticSearchTree from(const Container& sorted);
+
+    bool search(const T& val) const;
+    const T* lower_bound(const T& val) const;
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    void display() const;
+};
+
+template<typename T>
+template<typename InputIt, typename>
+staticSearchTree<T>::staticSearchTree(InputIt first, InputIt last){
+    std::vector<T> sorted(first, last);
+    size_ = sorted.size();
+    data.resize(size_ + 1);
+    auto it = sorted.begin();
+    fill(it, 1);
+}
+
+template<typename T>
+template<typename Container>
+staticSearchTree<T> staticSearchTree<T>::from(const Container& sorted){
+    return staticSearchTree<T>(std::begin(sorted), std::end(sorted));
+}
+
+// In-order walk over the implicit tree assigns sorted keys to slots.
+template<typename T>
+template<typename RandomIt>
+void staticSearchTree<T>::fill(RandomIt& it, size_t k){
+    if(k > size_) return;
+    fill(it, 2 * k);
+    data[k] = *it++;
+    fill(it, 2 * k + 1);
+}
+
+// Returns the slot of the first key not less than val, or 0 if none. The
+// descent records every comparison as one bit of k; the answer is the last
+// slot where we went left, found by stripping the trailing ones.
+template<typename T>
+size_t staticSearchTree<T>::lowerBoundSlot(const T& val) const{
+    const T* base = data.data();
+    size_t k = 1;
+    while(k <= size_){
+#if defined(__GNUC__) || defined(__clang__)
+        __builtin_prefetch(base + k * PREFETCH);
+#endif
+        k = 2 * k + static_cast<size_t>(base[k] < val);
+    }
+#if defined(__GNUC__) || defined(__clang__)
+    k >>= __builtin_ffsll(static_cast<long long>(~k));
+#else
+    while(k & 1) k >>= 1;
+    k >>= 1;
+#endif
+    return k;
+}
+
+template<typename T>
+const T* staticSearchTree<T>::lower_bound(const T& val) const{
+    size_t k = lowerBoundSlot(val);
+    return k ? &data[k] : nullptr;
+}
+
+template<typename T>
+bool staticSearchTree<T>::search(const T& val) const{
+    size_t k = lowerBoundSlot(val);
+    return k && !(val < data[k]);
+}
+
+template<typename T>
+void staticSearchTree<T>::display() const{
+    for(size_t k = 1; k <= size_; ++k){
+        std::cout << data[k] << " ";
+    }
+    std::cout << std::endl;
+}
+
+#endif
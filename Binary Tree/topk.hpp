@@ -0,0 +1,134 @@
+#ifndef TOPK_HPP
+#define TOPK_HPP
+
+#include <vector>
+#include <utility>
+#include <iostream>
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+
+// Bounded selector that keeps the k largest items (by Compare) seen so far.
+// Items live in a fixed-capacity min-heap whose root is the current
+// threshold, so anything not better than the root is rejected with a
+// single comparison. All storage is reserved in the constructor.
+template<typename T, typename Compare = std::less<T>>
+class topk {
+    size_t k;
+    std::vector<T> data;
+    Compare comp;
+
+    void siftUp(size_t i);
+    void siftDown(size_t i);
+public:
+    explicit topk(size_t k_, const Compare& comp_ = Compare());
+
+    void push(const T& value);
+    void push(T&& value);
+    template<typename InputIt>
+    void push_range(InputIt first, InputIt last);
+    void merge(const topk& other);
+
+    const T& threshold() const;
+    bool full() const { return data.size() == k; }
+    size_t size() const { return data.size(); }
+    size_t capacity() const { return k; }
+    bool empty() const { return data.empty(); }
+    void clear() { data.clear(); }
+
+    const std::vector<T>& values() const { return data; }
+    std::vector<T> sorted() const;
+    void display() const;
+};
+
+template<typename T, typename Compare>
+topk<T, Compare>::topk(size_t k_, const Compare& comp_) : k(k_), comp(comp_){
+    data.reserve(k);
+}
+
+template<typename T, typename Compare>
+void topk<T, Compare>::push(const T& value){
+    if(data.size() < k){
+        data.push_back(value);
+        siftUp(data.size() - 1);
+    }
+    else if(k > 0 && comp(data[0], value)){
+        data[0] = value;
+        siftDown(0);
+    }
+}
+
+template<typename T, typename Compare>
+void topk<T, Compare>::push(T&& value){
+    if(data.size() < k){
+        data.push_back(std::move(value));
+        siftUp(data.size() - 1);
+    }
+    else if(k > 0 && comp(data[0], value)){
+        data[0] = std::move(value);
+        siftDown(0);
+    }
+}
+
+template<typename T, typename Compare>
+template<typename InputIt>
+void topk<T, Compare>::push_range(InputIt first, InputIt last){
+    for(; first != last; ++first) push(*first);
+}
+
+// Combines a partial result from another scan; capacities may differ, the
+// result keeps this selector's k.
+template<typename T, typename Compare>
+void topk<T, Compare>::merge(const topk& other){
+    if(this == &other) return;
+    for(const T& value : other.data) push(value);
+}
+
+template<typename T, typename Compare>
+const T& topk<T, Compare>::threshold() const{
+    if(empty()){
+        throw std::out_of_range("Empty topk");
+    }
+    return data[0];
+}
+
+template<typename T, typename Compare>
+std::vector<T> topk<T, Compare>::sorted() const{
+    std::vector<T> result(data);
+    std::sort(result.begin(), result.end(), [this](const T& a, const T& b){ return comp(b, a); });
+    return result;
+}
+
+template<typename T, typename Compare>
+void topk<T, Compare>::siftUp(size_t i){
+    while(i > 0){
+        size_t parent = (i - 1) / 2;
+        if(!comp(data[i], data[parent])) break;
+        std::swap(data[i], data[parent]);
+        i = parent;
+    }
+}
+
+template<typename T, typename Compare>
+void topk<T, Compare>::siftDown(size_t i){
+    size_t n = data.size();
+    while(true){
+        size_t left = 2 * i + 1;
+        if(left >= n) break;
+        size_t right = left + 1;
+        size_t min = (right < n && comp(data[right], data[left])) ? right : left;
+        if(!comp(data[min], data[i])) break;
+        std::swap(data[i], data[min]);
+        i = min;
+    }
+}
+
+template<typename T, typename Compare>
+void topk<T, Compare>::display() const{
+    for(const T& value : sorted()){
+        std::cout << value << " ";
+    }
+    std::cout << std::endl;
+}
+
+#endif
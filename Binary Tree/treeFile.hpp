@@ -0,0 +1,255 @@
+#ifndef TREE_FILE_HPP
+#define TREE_FILE_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <istream>
+#include <ostream>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <limits>
+#include <algorithm>
+#include "simdSearch.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define TREE_FILE_MMAP 1
+#endif
+
+// On-disk format shared by avl::save/load and binarySearchTree::save/load:
+//
+//   treeFileHeader (32 bytes)
+//   count keys, raw bytes, ascending
+//   count int32 multiplicities, only when flags has TREE_FILE_COUNTED
+//
+// Keys are written with memcpy, so T must be trivially copyable, and files
+// are only portable between machines with the same T layout and byte order.
+// Keys start at offset 32, which keeps them aligned in a mapped file.
+
+struct treeFileHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t keySize;
+    uint32_t flags;
+    uint64_t count;
+    uint64_t reserved;
+};
+
+constexpr uint32_t TREE_FILE_VERSION = 1;
+constexpr uint32_t TREE_FILE_COUNTED = 1;
+
+template<typename T>
+void writeTreeHeader(std::ostream& os, uint64_t count, bool counted){
+    static_assert(std::is_trivially_copyable<T>::value, "tree files store keys as raw bytes");
+    treeFileHeader header{};
+    std::memcpy(header.magic, "TREE", 4);
+    header.version = TREE_FILE_VERSION;
+    header.keySize = sizeof(T);
+    header.flags = counted ? TREE_FILE_COUNTED : 0;
+    header.count = count;
+    os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+template<typename T>
+void checkTreeHeader(const treeFileHeader& header){
+    if(std::memcmp(header.magic, "TREE", 4) != 0 || header.version != TREE_FILE_VERSION){
+        throw std::runtime_error("Not a tree file");
+    }
+    if(header.keySize != sizeof(T)){
+        throw std::runtime_error("Tree file was written for a different key type");
+    }
+}
+
+template<typename T>
+treeFileHeader readTreeHeader(std::istream& is){
+    static_assert(std::is_trivially_copyable<T>::value, "tree files store keys as raw bytes");
+    treeFileHeader header;
+    if(!is.read(reinterpret_cast<char*>(&header), sizeof(header))){
+        throw std::runtime_error("Truncated tree file");
+    }
+    checkTreeHeader<T>(header);
+    return header;
+}
+
+template<typename U>
+void writeTreeBlock(std::ostream& os, const U* data, size_t count){
+    os.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(count * sizeof(U)));
+}
+
+template<typename U>
+void readTreeBlock(std::istream& is, U* data, size_t count){
+    if(!is.read(reinterpret_cast<char*>(data), static_cast<std::streamsize>(count * sizeof(U)))){
+        throw std::runtime_error("Truncated tree file");
+    }
+}
+
+// Reads the key block, and the multiplicity block when the file has one,
+// after readTreeHeader. Both are read in chunks, so a header claiming more
+// keys than the file holds fails on the short read instead of allocating
+// for the claimed count up front. Keys must be ascending, strictly so in a
+// counted file, and every multiplicity at least 1. counts may be null to
+// skip the multiplicities.
+template<typename T>
+void readTreeKeys(std::istream& is, const treeFileHeader& header, std::vector<T>& keys, std::vector<int32_t>* counts){
+    if(header.count > static_cast<uint64_t>(std::numeric_limits<int>::max())){
+        throw std::runtime_error("Tree file too large");
+    }
+    const size_t n = static_cast<size_t>(header.count);
+    const bool countedFile = header.flags & TREE_FILE_COUNTED;
+    const size_t chunk = 4096;
+    keys.clear();
+    keys.reserve(std::min(n, chunk));
+    while(keys.size() < n){
+        size_t from = keys.size();
+        keys.resize(from + std::min(chunk, n - from));
+        readTreeBlock(is, keys.data() + from, keys.size() - from);
+        for(size_t i = from == 0 ? 1 : from; i < keys.size(); ++i){
+            if(keys[i] < keys[i - 1] || (countedFile && !(keys[i - 1] < keys[i]))){
+                throw std::runtime_error("Tree file keys are not sorted");
+            }
+        }
+    }
+    if(!countedFile) return;
+    std::vector<int32_t> skipped;
+    std::vector<int32_t>& out = counts ? *counts : skipped;
+    out.clear();
+    out.reserve(std::min(n, chunk));
+    for(size_t done = 0; done < n;){
+        size_t len = std::min(chunk, n - done);
+        size_t from = counts ? out.size() : 0;
+        out.resize(from + len);
+        readTreeBlock(is, out.data() + from, len);
+        for(size_t i = from; i < from + len; ++i){
+            if(out[i] < 1){
+                throw std::runtime_error("Corrupt tree file");
+            }
+        }
+        done += len;
+    }
+}
+
+// Read-only view of a saved tree. On POSIX systems the file is mapped and
+// searched in place, so opening it costs O(1) regardless of its size and
+// pages are brought in by the first lookups that touch them; elsewhere the
+// file is read into memory. Lookups are binary searches that finish with
+// the SIMD block kernel.
+template<typename T>
+class mappedTree {
+    const unsigned char* base;
+    size_t bytes;
+    std::vector<unsigned char> buffer;
+    const T* keys;
+    const unsigned char* counts;    // int32 each, not necessarily aligned
+    size_t size_;
+public:
+    explicit mappedTree(const std::string& path);
+    mappedTree(const mappedTree&) = delete;
+    mappedTree& operator=(const mappedTree&) = delete;
+    ~mappedTree();
+
+    bool search(const T& val) const;
+    const T* lower_bound(const T& val) const { return simdLowerBound(keys, keys + size_, val); }
+    int count(const T& val) const;
+    const T* begin() const { return keys; }
+    const T* end() const { return keys + size_; }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+};
+
+template<typename T>
+mappedTree<T>::mappedTree(const std::string& path) : base(nullptr), bytes(0), keys(nullptr), counts(nullptr), size_(0){
+    static_assert(std::is_trivially_copyable<T>::value, "tree files store keys as raw bytes");
+    static_assert(alignof(T) <= sizeof(treeFileHeader), "keys would be misaligned in the file");
+#ifdef TREE_FILE_MMAP
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if(fd < 0){
+        throw std::runtime_error("Cannot open " + path);
+    }
+    struct stat st;
+    if(::fstat(fd, &st) != 0){
+        ::close(fd);
+        throw std::runtime_error("Cannot stat " + path);
+    }
+    bytes = static_cast<size_t>(st.st_size);
+    if(bytes >= sizeof(treeFileHeader)){
+        void* p = ::mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if(p == MAP_FAILED){
+            throw std::runtime_error("Cannot map " + path);
+        }
+        base = static_cast<const unsigned char*>(p);
+    }
+    else ::close(fd);
+#else
+    std::ifstream in(path, std::ios::binary);
+    if(!in){
+        throw std::runtime_error("Cannot open " + path);
+    }
+    buffer.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    bytes = buffer.size();
+    base = buffer.data();
+#endif
+    try{
+        if(bytes < sizeof(treeFileHeader)){
+            throw std::runtime_error("Truncated tree file");
+        }
+        treeFileHeader header;
+        std::memcpy(&header, base, sizeof(header));
+        checkTreeHeader<T>(header);
+        // Compared by division so a forged count cannot wrap the size.
+        const size_t perKey = sizeof(T) + ((header.flags & TREE_FILE_COUNTED) ? sizeof(int32_t) : 0);
+        if(header.count > (bytes - sizeof(header)) / perKey){
+            throw std::runtime_error("Truncated tree file");
+        }
+        size_ = static_cast<size_t>(header.count);
+        keys = reinterpret_cast<const T*>(base + sizeof(header));
+        if(header.flags & TREE_FILE_COUNTED){
+            counts = base + sizeof(header) + size_ * sizeof(T);
+        }
+    }
+    catch(...){
+#ifdef TREE_FILE_MMAP
+        if(base) ::munmap(const_cast<unsigned char*>(base), bytes);
+#endif
+        throw;
+    }
+}
+
+template<typename T>
+mappedTree<T>::~mappedTree(){
+#ifdef TREE_FILE_MMAP
+    if(base) ::munmap(const_cast<unsigned char*>(base), bytes);
+#endif
+}
+
+template<typename T>
+bool mappedTree<T>::search(const T& val) const{
+    const T* it = lower_bound(val);
+    return it != end() && !(val < *it);
+}
+
+// Copies of val; in a file written without multiplicities equal keys are
+// stored side by side.
+template<typename T>
+int mappedTree<T>::count(const T& val) const{
+    const T* it = lower_bound(val);
+    if(counts){
+        if(it == end() || val < *it) return 0;
+        int32_t c;
+        std::memcpy(&c, counts + (it - keys) * sizeof(int32_t), sizeof(c));
+        return c;
+    }
+    int result = 0;
+    for(; it != end() && !(val < *it); ++it) ++result;
+    return result;
+}
+
+#endif
@@ -0,0 +1,143 @@
+#ifndef INTEGER_QUEUES_HPP
+#define INTEGER_QUEUES_HPP
+
+#include <vector>
+#include <utility>
+#include <stdexcept>
+#include <limits>
+
+// Monotone priority queues for non-negative integer keys. Both expose the
+// subset of std::priority_queue<std::pair<int,int>, ..., std::greater<>>
+// that dijkstra uses: push({key, value}), top(), pop(), empty(). Keys pushed
+// must never be smaller than the last key returned by top().
+
+// Radix heap: bucket i holds keys whose highest bit differing from the last
+// extracted key is bit i - 1. Each element moves to a lower bucket at most
+// 32 times, so a push/pop pair costs O(log C) amortized.
+class radixHeap {
+    static constexpr int BUCKETS = std::numeric_limits<unsigned>::digits + 1;
+    std::vector<std::pair<int,int>> buckets[BUCKETS];
+    unsigned last;
+    size_t size_;
+
+    static int bucketOf(unsigned key, unsigned last);
+    void pull();
+public:
+    radixHeap() noexcept : last(0), size_(0) {}
+
+    void push(const std::pair<int,int>& item);
+    const std::pair<int,int>& top();
+    void pop();
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+};
+
+inline int radixHeap::bucketOf(unsigned key, unsigned last){
+    unsigned diff = key ^ last;
+    int bucket = 0;
+    while(diff){
+        ++bucket;
+        diff >>= 1;
+    }
+    return bucket;
+}
+
+inline void radixHeap::push(const std::pair<int,int>& item){
+    if(item.first < 0 || static_cast<unsigned>(item.first) < last){
+        throw std::invalid_argument("radixHeap key is below the last extracted key");
+    }
+    buckets[bucketOf(item.first, last)].push_back(item);
+    ++size_;
+}
+
+// Refills bucket 0 from the first non-empty bucket: its minimum becomes the
+// new `last` and every other element there drops to a lower bucket.
+inline void radixHeap::pull(){
+    if(!buckets[0].empty()) return;
+    int i = 1;
+    while(buckets[i].empty()) ++i;
+    unsigned min = std::numeric_limits<unsigned>::max();
+    for(const auto& item : buckets[i]){
+        if(static_cast<unsigned>(item.first) < min) min = item.first;
+    }
+    last = min;
+    for(const auto& item : buckets[i]){
+        buckets[bucketOf(item.first, last)].push_back(item);
+    }
+    buckets[i].clear();
+}
+
+inline const std::pair<int,int>& radixHeap::top(){
+    if(empty()){
+        throw std::out_of_range("Empty radix heap");
+    }
+    pull();
+    return buckets[0].back();
+}
+
+inline void radixHeap::pop(){
+    if(empty()){
+        throw std::out_of_range("Empty radix heap");
+    }
+    pull();
+    buckets[0].pop_back();
+    --size_;
+}
+
+// Dial's bucket queue: with edge weights in [0, C] every live key lies in
+// [cur, cur + C], so C + 1 circular buckets are enough. Pop scans forward
+// to the next non-empty bucket, giving O(V * C + E) for a whole run.
+class bucketQueue {
+    std::vector<std::vector<std::pair<int,int>>> buckets;
+    long long cur;
+    size_t size_;
+
+    size_t slot(long long key) const { return static_cast<size_t>(key % static_cast<long long>(buckets.size())); }
+    void advance();
+public:
+    explicit bucketQueue(int maxWeight);
+
+    void push(const std::pair<int,int>& item);
+    const std::pair<int,int>& top();
+    void pop();
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+};
+
+inline bucketQueue::bucketQueue(int maxWeight) : cur(0), size_(0){
+    if(maxWeight < 0){
+        throw std::invalid_argument("bucketQueue needs non-negative weights");
+    }
+    buckets.resize(static_cast<size_t>(maxWeight) + 1);
+}
+
+inline void bucketQueue::push(const std::pair<int,int>& item){
+    if(item.first < cur || item.first - cur >= static_cast<long long>(buckets.size())){
+        throw std::invalid_argument("bucketQueue key outside of the current window");
+    }
+    buckets[slot(item.first)].push_back(item);
+    ++size_;
+}
+
+inline void bucketQueue::advance(){
+    while(buckets[slot(cur)].empty()) ++cur;
+}
+
+inline const std::pair<int,int>& bucketQueue::top(){
+    if(empty()){
+        throw std::out_of_range("Empty bucket queue");
+    }
+    advance();
+    return buckets[slot(cur)].back();
+}
+
+inline void bucketQueue::pop(){
+    if(empty()){
+        throw std::out_of_range("Empty bucket queue");
+    }
+    advance();
+    buckets[slot(cur)].pop_back();
+    --size_;
+}
+
+#endif // INTEGER_QUEUES_HPP
@@ -9,9 +9,13 @@
 #include <iostream>
 #include <functional>
 #include <limits>
+#include <stdexcept>
+#include "integerQueues.hpp"
 
 #define DIRECTED true
 
+enum class pqBackend { binary, radix, dial };
+
 template<bool directed = false>
 class graphListWeighted {
     std::vector<std::list<std::pair<int,int>>> graph;
@@ -23,6 +27,9 @@ class graphListWeighted {
     int  _countPath(int cur, int dst, std::vector<bool>& visited);
     bool _hasCycle(int u, int parent, std::vector<bool>& visited);
     std::vector<std::vector<std::pair<int,int>>> _transpose();
+    int _maxWeight() const;
+    template<typename Queue>
+    std::vector<int> _dijkstra(int source, Queue& pq);
 
 public:
     graphListWeighted() = default;
@@ -41,7 +48,7 @@ public:
     std::vector<int> topologicalSort();
     std::vector<std::vector<int>> kosarajuSCC();
     std::vector<std::vector<int>> tarjanSCC();
-    std::vector<int> dijkstra(int source);
+    std::vector<int> dijkstra(int source, pqBackend backend = pqBackend::binary);
 };
 
 template<bool directed = false>
@@ -55,6 +62,9 @@ class graphMatrixWeighted {
     int  _countPath(int cur, int dst, std::vector<bool>& visited);
     bool _hasCycle(int u, int parent, std::vector<bool>& visited);
     std::vector<std::vector<std::pair<int,int>>> _transpose();
+    int _maxWeight() const;
+    template<typename Queue>
+    std::vector<int> _dijkstra(int source, Queue& pq);
 
 public:
     graphMatrixWeighted() = default;
@@ -73,7 +83,7 @@ public:
     std::vector<int> topologicalSort();
     std::vector<std::vector<int>> kosarajuSCC();
     std::vector<std::vector<int>> tarjanSCC();
-    std::vector<int> dijkstra(int source);
+    std::vector<int> dijkstra(int source, pqBackend backend = pqBackend::binary);
 };
 
 template<bool directed>
@@ -112,12 +122,41 @@ void graphListWeighted<directed>::printGraph() const {
 }
 
 template<bool directed>
-std::vector<int> graphListWeighted<directed>::dijkstra(int source){
+std::vector<int> graphListWeighted<directed>::dijkstra(int source, pqBackend backend){
     static_assert(directed, "dijkstra is not supported for undirected graphs");
+    if(backend == pqBackend::radix){
+        _maxWeight();
+        radixHeap pq;
+        return _dijkstra(source, pq);
+    }
+    if(backend == pqBackend::dial){
+        bucketQueue pq(_maxWeight());
+        return _dijkstra(source, pq);
+    }
+    std::priority_queue<std::pair<int, int>, std::vector<std::pair<int, int>>, std::greater<std::pair<int, int>>> pq;
+    return _dijkstra(source, pq);
+}
+
+template<bool directed>
+int graphListWeighted<directed>::_maxWeight() const {
+    int maxWeight = 0;
+    for(const auto& edges : graph){
+        for(const auto& edge : edges){
+            if(edge.second < 0){
+                throw std::invalid_argument("integer priority queues need non-negative weights");
+            }
+            maxWeight = std::max(maxWeight, edge.second);
+        }
+    }
+    return maxWeight;
+}
+
+template<bool directed>
+template<typename Queue>
+std::vector<int> graphListWeighted<directed>::_dijkstra(int source, Queue& pq){
     const int INF = std::numeric_limits<int>::max();
     int size = graph.size();
     std::vector<int> dist(size, INF);
-    std::priority_queue<std::pair<int, int>, std::vector<std::pair<int, int>>, std::greater<std::pair<int, int>>> pq;
     dist[source] = 0;
     pq.push({0, source});
     
@@ -830,12 +869,41 @@ std::vector<std::vector<int>> graphMatrixWeighted<directed>::kosarajuSCC(){
 }
 
 template<bool directed>
-std::vector<int> graphMatrixWeighted<directed>::dijkstra(int source){
+std::vector<int> graphMatrixWeighted<directed>::dijkstra(int source, pqBackend backend){
     static_assert(directed, "dijkstra is not supported for undirected graphs");
+    if(backend == pqBackend::radix){
+        _maxWeight();
+        radixHeap pq;
+        return _dijkstra(source, pq);
+    }
+    if(backend == pqBackend::dial){
+        bucketQueue pq(_maxWeight());
+        return _dijkstra(source, pq);
+    }
+    std::priority_queue<std::pair<int, int>, std::vector<std::pair<int, int>>, std::greater<std::pair<int, int>>> pq;
+    return _dijkstra(source, pq);
+}
+
+template<bool directed>
+int graphMatrixWeighted<directed>::_maxWeight() const {
+    int maxWeight = 0;
+    for(const auto& edges : graph){
+        for(const auto& edge : edges){
+            if(edge.second < 0){
+                throw std::invalid_argument("integer priority queues need non-negative weights");
+            }
+            maxWeight = std::max(maxWeight, edge.second);
+        }
+    }
+    return maxWeight;
+}
+
+template<bool directed>
+template<typename Queue>
+std::vector<int> graphMatrixWeighted<directed>::_dijkstra(int source, Queue& pq){
     const int INF = std::numeric_limits<int>::max();
     int size = graph.size();
     std::vector<int> dist(size, INF);
-    std::priority_queue<std::pair<int, int>, std::vector<std::pair<int, int>>, std::greater<std::pair<int, int>>> pq;
     dist[source] = 0;
     pq.push({0, source});
     
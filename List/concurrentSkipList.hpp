@@ -0,0 +1,490 @@
+#ifndef CONCURRENT_SKIP_LIST_HPP
+#define CONCURRENT_SKIP_LIST_HPP
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <new>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+#include <iostream>
+#include <functional>
+#include <memory>
+
+// Concurrent ordered set (lazy skip list, Herlihy, Lev, Luchangco & Shavit).
+//
+// search() takes no locks and never retries: it walks the towers with
+// acquire loads and checks the marked/fullyLinked flags of the node it
+// lands on. insert() and remove() lock only the predecessors of the key
+// they change, validate that nothing moved, and retry otherwise, so writers
+// on different parts of the key space do not block each other.
+//
+// Removed nodes may still be visited by concurrent readers, so memory is
+// reclaimed by epochs (Fraser). Every thread owns one cache-line-sized slot
+// per list, found through a small thread-local cache, and an operation
+// announces the global epoch in it while it runs: a store to its own line
+// and a fence, nothing shared is written. A removed node is retired under
+// the epoch current at that time, and the epoch only advances once every
+// active slot has announced it, so nodes retired two epochs back can no
+// longer be reached by anyone and are freed while the list stays in use.
+template<typename T>
+class concurrentSkipList {
+    static constexpr int MAX_LEVEL = 32;
+
+    struct links {
+        std::mutex lock;
+        std::atomic<bool> marked{false};
+        std::atomic<bool> fullyLinked{false};
+        int topLevel;
+        std::atomic<links*>* next;  // topLevel + 1 entries, stored right after the node
+    };
+    struct skipNode : links {
+        T val;
+        explicit skipNode(const T& val_) : val(val_) {}
+    };
+
+    // A thread's slot for one list. epoch is QUIESCENT outside operations;
+    // depth lets an operation nest inside another on the same list (a
+    // for_each callback calling search) and is only touched by the owner.
+    static constexpr uint64_t QUIESCENT = ~uint64_t(0);
+    struct alignas(64) epochSlot {
+        std::atomic<uint64_t> epoch{QUIESCENT};
+        std::atomic<bool> owned{true};
+        int depth = 0;
+        epochSlot* next = nullptr;
+    };
+    // Slots outlive the list while some thread's cache still refers to
+    // them; the cache holds a weak_ptr, used only to give a slot back.
+    struct slotRegistry {
+        std::atomic<epochSlot*> slots{nullptr};
+        ~slotRegistry();
+    };
+    struct slotCache {
+        static constexpr size_t CAPACITY = 8;
+        struct entry {
+            uint64_t list;
+            epochSlot* slot;
+            std::weak_ptr<slotRegistry> registry;
+        };
+        std::vector<entry> entries;
+        static void release(entry& e);
+        ~slotCache() { for(entry& e : entries) release(e); }
+    };
+    class epochGuard {
+        epochSlot* slot;
+    public:
+        explicit epochGuard(const concurrentSkipList& list);
+        epochGuard(const epochGuard&) = delete;
+        epochGuard& operator=(const epochGuard&) = delete;
+        ~epochGuard(){
+            if(--slot->depth == 0) slot->epoch.store(QUIESCENT, std::memory_order_release);
+        }
+    };
+    static constexpr size_t RECLAIM_BATCH = 64;
+
+    links* head;
+    std::atomic<size_t> size_{0};
+    std::atomic<int> level_{0};     // highest topLevel ever linked; searches start here
+    alignas(64) std::atomic<uint64_t> epoch_{0};   // read by every operation, kept off the writers' lines
+    alignas(64) const uint64_t id_;
+    std::shared_ptr<slotRegistry> registry_;
+    std::mutex retiredLock;
+    std::vector<skipNode*> retired[3];  // indexed by retire epoch % 3
+
+    template<typename Node, typename... Args>
+    static Node* allocate_(int topLevel, Args&&... args);
+    template<typename Node>
+    static void free_(Node* n) noexcept;
+    static const T& key_(links* n) { return static_cast<skipNode*>(n)->val; }
+    static uint64_t random_();
+    static int randomLevel_();
+    int find_(const T& val, links** preds, links** succs) const;
+    static void unlock_(links** preds, int highestLocked);
+    void retire_(skipNode* n);
+    bool tryAdvance_();
+    epochSlot* slot_() const;
+    epochSlot* claimSlot_() const;
+
+public:
+    concurrentSkipList();
+    concurrentSkipList(const concurrentSkipList&) = delete;
+    concurrentSkipList& operator=(const concurrentSkipList&) = delete;
+    ~concurrentSkipList();
+
+    bool insert(const T& val);
+    bool remove(const T& val);
+    bool search(const T& val) const;
+    template<typename Fn>
+    void for_each(Fn fn) const;
+    void reclaim();
+    size_t retiredCount();
+    size_t size() const { return size_.load(std::memory_order_relaxed); }
+    bool empty() const { return size() == 0; }
+    void display() const;
+};
+
+// Node and tower share one allocation; the tower follows the node, padded
+// to pointer alignment.
+template<typename T>
+template<typename Node, typename... Args>
+Node* concurrentSkipList<T>::allocate_(int topLevel, Args&&... args){
+    constexpr size_t align = alignof(std::atomic<links*>);
+    constexpr size_t offset = (sizeof(Node) + align - 1) / align * align;
+    unsigned char* raw = static_cast<unsigned char*>(
+        ::operator new(offset + (topLevel + 1) * sizeof(std::atomic<links*>)));
+    Node* n;
+    try{
+        n = new (raw) Node(std::forward<Args>(args)...);
+    }
+    catch(...){
+        ::operator delete(raw);
+        throw;
+    }
+    n->topLevel = topLevel;
+    n->next = reinterpret_cast<std::atomic<links*>*>(raw + offset);
+    for(int l = 0; l <= topLevel; ++l) new (&n->next[l]) std::atomic<links*>(nullptr);
+    return n;
+}
+
+template<typename T>
+template<typename Node>
+void concurrentSkipList<T>::free_(Node* n) noexcept{
+    n->~Node();
+    ::operator delete(static_cast<void*>(n));
+}
+
+template<typename T>
+concurrentSkipList<T>::concurrentSkipList()
+    : id_([]{ static std::atomic<uint64_t> next{0}; return next.fetch_add(1); }()),
+      registry_(std::make_shared<slotRegistry>()){
+    head = allocate_<links>(MAX_LEVEL - 1);
+    head->fullyLinked = true;
+}
+
+template<typename T>
+concurrentSkipList<T>::~concurrentSkipList(){
+    links* tmp = head->next[0].load(std::memory_order_relaxed);
+    while(tmp){
+        links* next = tmp->next[0].load(std::memory_order_relaxed);
+        free_(static_cast<skipNode*>(tmp));
+        tmp = next;
+    }
+    for(auto& bucket : retired){
+        for(skipNode* n : bucket) free_(n);
+    }
+    free_(head);
+}
+
+template<typename T>
+concurrentSkipList<T>::slotRegistry::~slotRegistry(){
+    epochSlot* slot = slots.load(std::memory_order_relaxed);
+    while(slot){
+        epochSlot* next = slot->next;
+        delete slot;
+        slot = next;
+    }
+}
+
+// Gives the slot back for another thread to claim, unless the list is gone.
+template<typename T>
+void concurrentSkipList<T>::slotCache::release(entry& e){
+    if(std::shared_ptr<slotRegistry> alive = e.registry.lock()){
+        e.slot->owned.store(false, std::memory_order_release);
+    }
+}
+
+// List ids are never reused, so an entry for a destroyed list can linger in
+// the cache without ever matching again.
+template<typename T>
+typename concurrentSkipList<T>::epochSlot* concurrentSkipList<T>::slot_() const{
+    thread_local slotCache cache;
+    for(auto& e : cache.entries){
+        if(e.list == id_) return e.slot;
+    }
+    if(cache.entries.size() >= slotCache::CAPACITY){
+        for(auto it = cache.entries.begin(); it != cache.entries.end(); ++it){
+            if(it->registry.expired() || it->slot->depth == 0){
+                slotCache::release(*it);
+                cache.entries.erase(it);
+                break;
+            }
+        }
+    }
+    epochSlot* slot = claimSlot_();
+    cache.entries.push_back({id_, slot, registry_});
+    return slot;
+}
+
+// Takes over a slot given back by an exited thread, or publishes a new one.
+template<typename T>
+typename concurrentSkipList<T>::epochSlot* concurrentSkipList<T>::claimSlot_() const{
+    std::atomic<epochSlot*>& slots = registry_->slots;
+    for(epochSlot* s = slots.load(std::memory_order_acquire); s; s = s->next){
+        bool expected = false;
+        if(!s->owned.load(std::memory_order_relaxed) && s->owned.compare_exchange_strong(expected, true)){
+            return s;
+        }
+    }
+    epochSlot* slot = new epochSlot;
+    epochSlot* first = slots.load(std::memory_order_relaxed);
+    do slot->next = first;
+    while(!slots.compare_exchange_weak(first, slot));
+    return slot;
+}
+
+// Announces the current epoch in the thread's slot. The fence orders the
+// announcement before every node this operation reads.
+template<typename T>
+concurrentSkipList<T>::epochGuard::epochGuard(const concurrentSkipList& list) : slot(list.slot_()){
+    if(slot->depth++ == 0){
+        slot->epoch.store(list.epoch_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+}
+
+// Caller holds retiredLock. Moves the epoch on when every running operation
+// has seen the current one; what was retired two epochs ago is then
+// unreachable and freed.
+template<typename T>
+bool concurrentSkipList<T>::tryAdvance_(){
+    // Pairs with the fence in epochGuard: either this scan sees a reader's
+    // announcement, or that reader sees every unlink made before the scan.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    uint64_t e = epoch_.load();
+    for(epochSlot* s = registry_->slots.load(); s; s = s->next){
+        uint64_t announced = s->epoch.load();
+        if(announced != QUIESCENT && announced != e) return false;
+    }
+    if(!epoch_.compare_exchange_strong(e, e + 1)) return false;
+    auto& safe = retired[(e + 2) % 3];
+    for(skipNode* n : safe) free_(n);
+    safe.clear();
+    return true;
+}
+
+template<typename T>
+void concurrentSkipList<T>::retire_(skipNode* n){
+    std::lock_guard<std::mutex> guard(retiredLock);
+    auto& bucket = retired[epoch_.load() % 3];
+    bucket.push_back(n);
+    if(bucket.size() % RECLAIM_BATCH == 0) tryAdvance_();
+}
+
+template<typename T>
+uint64_t concurrentSkipList<T>::random_(){
+    thread_local uint64_t state = 0x9e3779b97f4a7c15ULL ^
+        static_cast<uint64_t>(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+// Geometric with p = 1/2: each level holds about half the nodes of the one below.
+template<typename T>
+int concurrentSkipList<T>::randomLevel_(){
+    uint64_t bits = random_();
+    int level = 0;
+    while((bits & 1) && level < MAX_LEVEL - 1){
+        ++level;
+        bits >>= 1;
+    }
+    return level;
+}
+
+// Fills preds/succs with the nodes around `val` on every level up to level_
+// and returns the highest level where a node equal to val was found, or -1.
+template<typename T>
+int concurrentSkipList<T>::find_(const T& val, links** preds, links** succs) const{
+    int found = -1;
+    links* pred = head;
+    for(int l = level_.load(std::memory_order_acquire); l >= 0; --l){
+        links* curr = pred->next[l].load(std::memory_order_acquire);
+        while(curr && key_(curr) < val){
+            pred = curr;
+            curr = pred->next[l].load(std::memory_order_acquire);
+        }
+        if(found == -1 && curr && !(val < key_(curr))) found = l;
+        preds[l] = pred;
+        succs[l] = curr;
+    }
+    return found;
+}
+
+// The same predecessor can cover several adjacent levels; it is locked once.
+template<typename T>
+void concurrentSkipList<T>::unlock_(links** preds, int highestLocked){
+    links* prev = nullptr;
+    for(int l = 0; l <= highestLocked; ++l){
+        if(preds[l] != prev){
+            preds[l]->lock.unlock();
+            prev = preds[l];
+        }
+    }
+}
+
+template<typename T>
+bool concurrentSkipList<T>::insert(const T& val){
+    const int topLevel = randomLevel_();
+    // Raised before the search so that find_ fills preds/succs up to topLevel.
+    int level = level_.load(std::memory_order_relaxed);
+    while(level < topLevel && !level_.compare_exchange_weak(level, topLevel)) {}
+    epochGuard guard(*this);
+    links* preds[MAX_LEVEL];
+    links* succs[MAX_LEVEL];
+    while(true){
+        int found = find_(val, preds, succs);
+        if(found != -1){
+            links* existing = succs[found];
+            if(!existing->marked.load()){
+                while(!existing->fullyLinked.load()) std::this_thread::yield();
+                return false;
+            }
+            continue;   // being removed; wait until it is unlinked
+        }
+
+        int highestLocked = -1;
+        links* prev = nullptr;
+        bool valid = true;
+        for(int l = 0; valid && l <= topLevel; ++l){
+            links* pred = preds[l];
+            links* succ = succs[l];
+            if(pred != prev){
+                pred->lock.lock();
+                highestLocked = l;
+                prev = pred;
+            }
+            valid = !pred->marked.load() && (!succ || !succ->marked.load()) &&
+                    pred->next[l].load(std::memory_order_acquire) == succ;
+        }
+        if(!valid){
+            unlock_(preds, highestLocked);
+            continue;
+        }
+
+        skipNode* fresh;
+        try{
+            fresh = allocate_<skipNode>(topLevel, val);
+        }
+        catch(...){
+            unlock_(preds, highestLocked);
+            throw;
+        }
+        for(int l = 0; l <= topLevel; ++l) fresh->next[l].store(succs[l], std::memory_order_relaxed);
+        for(int l = 0; l <= topLevel; ++l) preds[l]->next[l].store(fresh, std::memory_order_release);
+        fresh->fullyLinked = true;
+        unlock_(preds, highestLocked);
+        size_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+}
+
+template<typename T>
+bool concurrentSkipList<T>::remove(const T& val){
+    links* preds[MAX_LEVEL];
+    links* succs[MAX_LEVEL];
+    links* victim = nullptr;
+    bool isMarked = false;
+    int topLevel = -1;
+    epochGuard guard(*this);
+    while(true){
+        int found = find_(val, preds, succs);
+        if(!isMarked){
+            if(found == -1) return false;
+            victim = succs[found];
+            // Only a node fully inserted and seen at its own top level may be
+            // claimed; otherwise its tower could still be growing.
+            if(!victim->fullyLinked.load() || victim->topLevel != found || victim->marked.load()) return false;
+            topLevel = victim->topLevel;
+            victim->lock.lock();
+            if(victim->marked.load()){
+                victim->lock.unlock();
+                return false;
+            }
+            victim->marked = true;
+            isMarked = true;
+        }
+
+        int highestLocked = -1;
+        links* prev = nullptr;
+        bool valid = true;
+        for(int l = 0; valid && l <= topLevel; ++l){
+            links* pred = preds[l];
+            if(pred != prev){
+                pred->lock.lock();
+                highestLocked = l;
+                prev = pred;
+            }
+            valid = !pred->marked.load() && pred->next[l].load(std::memory_order_acquire) == victim;
+        }
+        if(!valid){
+            unlock_(preds, highestLocked);
+            continue;
+        }
+
+        for(int l = topLevel; l >= 0; --l){
+            preds[l]->next[l].store(victim->next[l].load(std::memory_order_relaxed), std::memory_order_release);
+        }
+        victim->lock.unlock();
+        unlock_(preds, highestLocked);
+        retire_(static_cast<skipNode*>(victim));
+        size_.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+}
+
+template<typename T>
+bool concurrentSkipList<T>::search(const T& val) const{
+    epochGuard guard(*this);
+    links* pred = head;
+    for(int l = level_.load(std::memory_order_acquire); l >= 0; --l){
+        links* curr = pred->next[l].load(std::memory_order_acquire);
+        while(curr && key_(curr) < val){
+            pred = curr;
+            curr = pred->next[l].load(std::memory_order_acquire);
+        }
+        if(curr && !(val < key_(curr))){
+            return curr->fullyLinked.load() && !curr->marked.load();
+        }
+    }
+    return false;
+}
+
+// Visits live keys in ascending order. Under concurrent writes this is
+// weakly consistent: each key present for the whole walk is seen once.
+template<typename T>
+template<typename Fn>
+void concurrentSkipList<T>::for_each(Fn fn) const{
+    epochGuard guard(*this);
+    links* tmp = head->next[0].load(std::memory_order_acquire);
+    while(tmp){
+        if(tmp->fullyLinked.load() && !tmp->marked.load()) fn(key_(tmp));
+        tmp = tmp->next[0].load(std::memory_order_acquire);
+    }
+}
+
+// Frees every retired node that no running operation can still reach.
+// Safe to call at any time; when the list is idle it frees all of them.
+// remove() already does this every RECLAIM_BATCH retirements.
+template<typename T>
+void concurrentSkipList<T>::reclaim(){
+    std::lock_guard<std::mutex> guard(retiredLock);
+    for(int i = 0; i < 3 && tryAdvance_(); ++i) {}
+}
+
+// Removed nodes not yet freed.
+template<typename T>
+size_t concurrentSkipList<T>::retiredCount(){
+    std::lock_guard<std::mutex> guard(retiredLock);
+    return retired[0].size() + retired[1].size() + retired[2].size();
+}
+
+template<typename T>
+void concurrentSkipList<T>::display() const{
+    for_each([](const T& val){ std::cout << val << " "; });
+    std::cout << std::endl;
+}
+
+#endif
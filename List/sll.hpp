@@ -30,6 +30,7 @@ public:
 
 private:
     node<T>* head;
+    node<T>* tail;
     size_type size_;
 
 public:
@@ -50,6 +51,9 @@ public:
     void pop_back();
     iterator insert(iterator pos, const_reference value);
     iterator insert(iterator pos, T&& value);
+    void splice(iterator pos, list& other);
+    void splice_after(iterator pos, list& other);
+    void append(list&& other);
     void remove(const T& value);
     iterator find(const T& value);
     const_iterator find(const T& value) const;
@@ -69,10 +73,10 @@ public:
 };
 
 template <typename T>
-list<T>::list() noexcept : head(nullptr), size_(0){}
+list<T>::list() noexcept : head(nullptr), tail(nullptr), size_(0){}
 
 template<typename T>
-list<T>::list(const list& other) : head(nullptr), size_(0){
+list<T>::list(const list& other) : head(nullptr), tail(nullptr), size_(0){
     node<T>* current = other.head;
     while(current != nullptr){
         push_back(current->value);
@@ -81,13 +85,14 @@ list<T>::list(const list& other) : head(nullptr), size_(0){
 }
 
 template<typename T>
-list<T>::list(list&& other) noexcept : head(other.head), size_(other.size_) {
+list<T>::list(list&& other) noexcept : head(other.head), tail(other.tail), size_(other.size_) {
     other.head = nullptr;
+    other.tail = nullptr;
     other.size_ = 0;
 }
 
 template<typename T>
-list<T>::list(std::initializer_list<T> init) : head(nullptr), size_(0){
+list<T>::list(std::initializer_list<T> init) : head(nullptr), tail(nullptr), size_(0){
     for(auto &i : init){
         push_back(i);
     }
@@ -116,8 +121,10 @@ list<T>& list<T>::operator=(list&& other) noexcept{
     if(this != &other){
         clear();
         head = other.head;
+        tail = other.tail;
         size_ = other.size_;
         other.head = nullptr;
+        other.tail = nullptr;
         other.size_ = 0;
     }
     return *this;
@@ -128,6 +135,7 @@ void list<T>::push_front(const_reference value){
     node<T>* new_node = new node<T>(value);
     new_node->next = head;
     head = new_node;
+    if(!tail) tail = new_node;
     ++size_;
 }
 
@@ -136,36 +144,33 @@ void list<T>::push_front(T&& value){
     node<T>* new_node = new node<T>(std::move(value));
     new_node->next = head;
     head = new_node;
+    if(!tail) tail = new_node;
     ++size_;
 }
 
 template<typename T>
 void list<T>::push_back(const_reference value){
+    node<T>* new_node = new node<T>(value);
     if(empty()){
-        head = new node<T>(value);
+        head = new_node;
     }
     else{
-        node<T>* current = head;
-        while (current->next != nullptr){
-            current = current->next;
-        }
-        current->next = new node<T>(value);
+        tail->next = new_node;
     }
+    tail = new_node;
     ++size_;
 }
 
 template<typename T>
 void list<T>::push_back(T&& value){
+    node<T>* new_node = new node<T>(std::move(value));
     if(empty()){
-        head = new node<T>(std::move(value));
+        head = new_node;
     }
     else{
-        node<T>* current = head;
-        while (current->next != nullptr){
-            current = current->next;
-        }
-        current->next = new node<T>(std::move(value));
+        tail->next = new_node;
     }
+    tail = new_node;
     ++size_;
 }
 
@@ -174,6 +179,7 @@ void list<T>::pop_front(){
     if(empty()) return;
     node<T>* tmp = head;
     head = head->next;
+    if(!head) tail = nullptr;
     delete tmp;
     --size_;
 }
@@ -183,15 +189,17 @@ void list<T>::pop_back(){
     if(empty()) return;
     if(head->next == nullptr){
         delete head;
-        head = nullptr;
+        head = tail = nullptr;
     }
     else{
+        // Singly linked: the new tail still has to be found from head.
         node<T>* current = head;
-        while(current->next->next != nullptr){
+        while(current->next != tail){
             current = current->next;
         }
-        delete current->next;
+        delete tail;
         current->next = nullptr;
+        tail = current;
     }
     --size_;
 }
@@ -202,6 +210,10 @@ typename list<T>::iterator list<T>::insert(iterator pos, const_reference value){
         push_front(value);
         return head;
     }
+    if(pos == nullptr){
+        push_back(value);
+        return tail;
+    }
     node<T>* current = head;
     while(current != nullptr && current->next != pos){
         current = current->next;
@@ -212,6 +224,7 @@ typename list<T>::iterator list<T>::insert(iterator pos, const_reference value){
     node<T>* new_node = new node<T>(value);
     new_node->next = current->next;
     current->next = new_node;
+    if(current == tail) tail = new_node;
     ++size_;
     return new_node;
 }
@@ -222,6 +235,10 @@ typename list<T>::iterator list<T>::insert(iterator pos, T&& value){
         push_front(std::move(value));
         return head;
     }
+    if(pos == nullptr){
+        push_back(std::move(value));
+        return tail;
+    }
     node<T>* current = head;
     while(current != nullptr && current->next != pos){
         current = current->next;
@@ -232,6 +249,7 @@ typename list<T>::iterator list<T>::insert(iterator pos, T&& value){
     node<T>* new_node = new node<T>(std::move(value));
     new_node->next = current->next;
     current->next = new_node;
+    if(current == tail) tail = new_node;
     ++size_;
     return new_node;
 }
@@ -247,7 +265,10 @@ void list<T>::remove(const T& value){
         --size_;
     }
 
-    if(head == nullptr) return;
+    if(head == nullptr){
+        tail = nullptr;
+        return;
+    }
 
     node<T>* current = head;
     while(current->next != nullptr){
@@ -261,6 +282,60 @@ void list<T>::remove(const T& value){
             current = current->next;
         }
     }
+    tail = current;
+}
+
+// Moves every node of other in front of pos without copying. O(1) when pos
+// is begin() or end(); any other position is first located from head.
+template<typename T>
+void list<T>::splice(iterator pos, list& other){
+    if(this == &other || other.empty()) return;
+    if(pos == head){
+        other.tail->next = head;
+        head = other.head;
+        if(!tail) tail = other.tail;
+    }
+    else if(pos == nullptr){
+        tail->next = other.head;
+        tail = other.tail;
+    }
+    else{
+        node<T>* current = head;
+        while(current != nullptr && current->next != pos){
+            current = current->next;
+        }
+        if(current == nullptr){
+            throw std::out_of_range("Итератор вне диапазона списка.");
+        }
+        splice_after(current, other);
+        return;
+    }
+    size_ += other.size_;
+    other.head = other.tail = nullptr;
+    other.size_ = 0;
+}
+
+// Moves every node of other right after pos, which must be a node of this
+// list; nullptr stands for the position before the first node. O(1).
+template<typename T>
+void list<T>::splice_after(iterator pos, list& other){
+    if(this == &other || other.empty()) return;
+    if(pos == nullptr){
+        splice(head, other);
+        return;
+    }
+    other.tail->next = pos->next;
+    pos->next = other.head;
+    if(pos == tail) tail = other.tail;
+    size_ += other.size_;
+    other.head = other.tail = nullptr;
+    other.size_ = 0;
+}
+
+// Concatenates other at the end in O(1).
+template<typename T>
+void list<T>::append(list&& other){
+    splice(nullptr, other);
 }
 
 template<typename T>
@@ -321,11 +396,7 @@ typename list<T>::reference list<T>::back(){
     if(empty()){
         throw std::out_of_range("Список пуст. Невозможно получить последний элемент.");
     }
-    node<T>* current = head;
-    while(current->next != nullptr){
-        current = current->next;
-    }
-    return current->value;
+    return tail->value;
 }
 
 template<typename T>
@@ -333,11 +404,7 @@ typename list<T>::const_reference list<T>::back() const{
     if(empty()){
         throw std::out_of_range("Список пуст. Невозможно получить последний элемент.");
     }
-    node<T>* current = head;
-    while(current->next != nullptr){
-        current = current->next;
-    }
-    return current->value;
+    return tail->value;
 }
 
 
@@ -5,6 +5,8 @@
 #include <utility>
 #include <stdexcept> 
 #include <iostream>
+#include <cstdint>
+#include <cstddef>
 
 template<typename T>
 struct node {
@@ -14,8 +16,18 @@ struct node {
     node<T>* left;   
     node<T>* right;
 
+    // Links of the skip-list index above the sorted chain; level 0 is left/right.
+    struct link {
+        node<T>* left;
+        node<T>* right;
+        std::size_t width;  // sorted positions between this node and right
+    };
+    int levels;
+    link* tower;     // levels - 1 entries, for levels 1 and up
+
     node()
-        : value{}, next(nullptr), prev(nullptr), left(nullptr), right(nullptr)
+        : value{}, next(nullptr), prev(nullptr), left(nullptr), right(nullptr),
+          levels(1), tower(nullptr)
     {}
 
     node(const T& value_,
@@ -23,7 +35,8 @@ struct node {
          node<T>* prev_ = nullptr,
          node<T>* left_ = nullptr,
          node<T>* right_ = nullptr)
-        : value(value_), next(next_), prev(prev_), left(left_), right(right_)
+        : value(value_), next(next_), prev(prev_), left(left_), right(right_),
+          levels(1), tower(nullptr)
     {}
 
     node(T&& value_,
@@ -31,10 +44,22 @@ struct node {
          node<T>* prev_ = nullptr,
          node<T>* left_ = nullptr,
          node<T>* right_ = nullptr)
-        : value(std::move(value_)), next(next_), prev(prev_), left(left_), right(right_)
+        : value(std::move(value_)), next(next_), prev(prev_), left(left_), right(right_),
+          levels(1), tower(nullptr)
     {}
+
+    node(const node&) = delete;
+    node& operator=(const node&) = delete;
+    ~node() { delete[] tower; }
 };
 
+// next/prev keep the insertion order, left/right keep the values sorted
+// (equal values in insertion order). The sorted chain is the bottom level of
+// an indexable skip list: every node gets a random number of extra levels,
+// and each link stores how many sorted positions it jumps over, so placing
+// a new node, lower_bound and kth_smallest take O(log n) expected time.
+// Unlinking needs no comparisons at all, since every level is doubly linked.
+
 template <typename T>
 class solist {
 public:
@@ -52,9 +77,21 @@ private:
     node<T>* high; 
     size_type size_;
 
+    static constexpr int MAX_LEVEL = 16;
+    using link = typename node<T>::link;
+
+    link index[MAX_LEVEL - 1];  // links out of the front of the sorted chain
+    int levels;
+    std::uint64_t seed;
+
 private:
     void unlink_from_sorted(node<T>* n);
     void link_into_sorted(node<T>* new_node);
+    int random_level();
+    link& link_at(node<T>* n, int level) { return n ? n->tower[level - 1] : index[level - 1]; }
+    const link& link_at(const node<T>* n, int level) const { return n ? n->tower[level - 1] : index[level - 1]; }
+    const node<T>* find_lower(const T& value, bool inclusive) const;
+    const node<T>* find_kth(size_type k) const;
 
 public:
     solist() noexcept;
@@ -93,8 +130,31 @@ public:
 
     const node<T>* begin() const { return head; }
     const node<T>* end()   const { return nullptr; }
+
+    // Queries on the sorted order; the returned nodes are walked with ->right.
+    // They are read-only: changing a value in place would leave its node at
+    // the wrong position in the sorted chain.
+    const node<T>* lower_bound(const T& value) const { return find_lower(value, true); }
+    const node<T>* upper_bound(const T& value) const { return find_lower(value, false); }
+    std::pair<const node<T>*, const node<T>*> range(const T& lo, const T& hi) const;
+    const_reference kth_smallest(size_type k) const { return find_kth(k)->value; }
 };
 
+template <typename T>
+int solist<T>::random_level()
+{
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+    std::uint64_t bits = seed;
+    int level = 1;
+    while ((bits & 3) == 0 && level < MAX_LEVEL) {
+        ++level;
+        bits >>= 2;
+    }
+    return level;
+}
+
 template <typename T>
 void solist<T>::unlink_from_sorted(node<T>* n)
 {
@@ -108,6 +168,26 @@ void solist<T>::unlink_from_sorted(node<T>* n)
     if (R) R->left = L;
     else high = L;
 
+    // Above n's own levels the link that jumped over n just gets shorter;
+    // its owner is found by walking back from n's predecessor one level down.
+    node<T>* pred = L;
+    for (int l = 1; l < levels; ++l) {
+        if (l < n->levels) {
+            link& own = n->tower[l - 1];
+            link& before = link_at(own.left, l);
+            before.right  = own.right;
+            before.width += own.width - 1;
+            if (own.right) own.right->tower[l - 1].left = own.left;
+            pred = own.left;
+        } else {
+            while (pred && pred->levels <= l) {
+                pred = (l == 1) ? pred->left : pred->tower[l - 2].left;
+            }
+            --link_at(pred, l).width;
+        }
+    }
+    while (levels > 1 && !index[levels - 2].right) --levels;
+
     n->left  = nullptr;
     n->right = nullptr;
 }
@@ -117,37 +197,102 @@ void solist<T>::link_into_sorted(node<T>* new_node)
 {
     if (!new_node) return;
 
-    if (!low && !high) {
-        low  = new_node;
-        high = new_node;
-        return;
+    const int top = random_level();
+    if (top > 1) new_node->tower = new link[top - 1];
+    new_node->levels = top;
+    for (; levels < top; ++levels) {
+        index[levels - 1] = link{nullptr, nullptr, size_ + 1};
     }
 
-    node<T>* tmp = low;
-    while (tmp && new_node->value >= tmp->value) {
-        tmp = tmp->right;
+    // Find the last node not greater than new_node on every level, counting
+    // the sorted positions passed on the way.
+    node<T>* update[MAX_LEVEL];
+    size_type update_rank[MAX_LEVEL];
+    node<T>* tmp = nullptr;
+    size_type rank = 0;
+    for (int l = levels - 1; l >= 1; --l) {
+        for (link* s = &link_at(tmp, l); s->right && !(new_node->value < s->right->value); s = &link_at(tmp, l)) {
+            rank += s->width;
+            tmp = s->right;
+        }
+        update[l] = tmp;
+        update_rank[l] = rank;
+    }
+    for (node<T>* r = tmp ? tmp->right : low; r && !(new_node->value < r->value); r = r->right) {
+        tmp = r;
+        ++rank;
+    }
+    const size_type new_rank = rank + 1;
+
+    new_node->left  = tmp;
+    new_node->right = tmp ? tmp->right : low;
+    if (new_node->right) new_node->right->left = new_node;
+    else high = new_node;
+    if (tmp) tmp->right = new_node;
+    else low = new_node;
+
+    for (int l = 1; l < levels; ++l) {
+        link& before = link_at(update[l], l);
+        if (l < top) {
+            link& own = new_node->tower[l - 1];
+            own.left  = update[l];
+            own.right = before.right;
+            own.width = before.width + update_rank[l] + 1 - new_rank;
+            if (before.right) before.right->tower[l - 1].left = new_node;
+            before.right = new_node;
+            before.width = new_rank - update_rank[l];
+        } else {
+            ++before.width;
+        }
     }
+}
 
-    if (tmp) {
-        // Вставляем перед tmp
-        new_node->right = tmp;
-        new_node->left  = tmp->left;
-        if (tmp->left) {
-            tmp->left->right = new_node;
-        } 
-        else low = new_node;
-        
-        tmp->left = new_node;
-    } else {
-        new_node->right = nullptr;
-        new_node->left  = high;
-        if (high) {
-            high->right = new_node;
+template <typename T>
+const node<T>* solist<T>::find_lower(const T& value, bool inclusive) const
+{
+    // inclusive: first node not less than value, otherwise first greater.
+    auto before = [&](const node<T>* n) {
+        return inclusive ? n->value < value : !(value < n->value);
+    };
+    const node<T>* tmp = nullptr;
+    for (int l = levels - 1; l >= 1; --l) {
+        while (link_at(tmp, l).right && before(link_at(tmp, l).right)) {
+            tmp = link_at(tmp, l).right;
         }
-        high = new_node;
     }
-    if (new_node->value < low->value) low = new_node;
-    
+    const node<T>* r = tmp ? tmp->right : low;
+    while (r && before(r)) r = r->right;
+    return r;
+}
+
+// k-th smallest value, counting from 0.
+template <typename T>
+const node<T>* solist<T>::find_kth(size_type k) const
+{
+    if (k >= size_) {
+        throw std::out_of_range("Индекс вне диапазона списка.");
+    }
+    const node<T>* tmp = nullptr;
+    size_type rank = 0;
+    for (int l = levels - 1; l >= 1; --l) {
+        while (link_at(tmp, l).right && rank + link_at(tmp, l).width <= k + 1) {
+            rank += link_at(tmp, l).width;
+            tmp = link_at(tmp, l).right;
+        }
+    }
+    for (; rank < k + 1; ++rank) {
+        tmp = tmp ? tmp->right : low;
+    }
+    return tmp;
+}
+
+// Nodes with lo <= value <= hi as [first, last) along ->right.
+template <typename T>
+std::pair<const node<T>*, const node<T>*> solist<T>::range(const T& lo, const T& hi) const
+{
+    const node<T>* first = lower_bound(lo);
+    if (hi < lo) return {first, first};
+    return {first, upper_bound(hi)};
 }
 
 
@@ -157,7 +302,9 @@ solist<T>::solist() noexcept
       tail(nullptr),
       low(nullptr),
       high(nullptr),
-      size_(0)
+      size_(0),
+      levels(1),
+      seed(0x9E3779B97F4A7C15ull)
 {}
 
 template<typename T>
@@ -167,7 +314,8 @@ solist<T>::~solist(){
 
 template <typename T>
 solist<T>::solist(const solist& other)
-    : head(nullptr), tail(nullptr), low(nullptr), high(nullptr), size_(0)
+    : head(nullptr), tail(nullptr), low(nullptr), high(nullptr), size_(0),
+      levels(1), seed(0x9E3779B97F4A7C15ull)
 {
     node<T>* tmp = other.head;
     while(tmp){
@@ -180,8 +328,10 @@ template <typename T>
 solist<T>::solist(solist&& other) noexcept
     : head(other.head), tail(other.tail),
       low(other.low), high(other.high),
-      size_(other.size_)
+      size_(other.size_), levels(other.levels), seed(other.seed)
 {
+    for (int l = 1; l < levels; ++l) index[l - 1] = other.index[l - 1];
+    other.levels = 1;
     other.head  = nullptr;
     other.tail  = nullptr;
     other.low   = nullptr;
@@ -191,7 +341,8 @@ solist<T>::solist(solist&& other) noexcept
 
 template <typename T>
 solist<T>::solist(std::initializer_list<T> init)
-    : head(nullptr), tail(nullptr), low(nullptr), high(nullptr), size_(0)
+    : head(nullptr), tail(nullptr), low(nullptr), high(nullptr), size_(0),
+      levels(1), seed(0x9E3779B97F4A7C15ull)
 {
     for(const auto& val : init){
         push_back(val);
@@ -220,6 +371,9 @@ solist<T>& solist<T>::operator=(solist<T>&& other) noexcept {
         low   = other.low;
         high  = other.high;
         size_ = other.size_;
+        levels = other.levels;
+        for (int l = 1; l < levels; ++l) index[l - 1] = other.index[l - 1];
+        other.levels = 1;
 
         other.head  = nullptr;
         other.tail  = nullptr;
@@ -395,6 +549,7 @@ void solist<T>::clear(){
     }
     head = tail = low = high = nullptr;
     size_ = 0;
+    levels = 1;
 }
 
 
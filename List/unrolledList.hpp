@@ -0,0 +1,419 @@
+#ifndef UNROLLED_LIST_HPP
+#define UNROLLED_LIST_HPP
+
+#include <initializer_list>
+#include <utility>
+#include <stdexcept>
+#include <iostream>
+#include <iterator>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+
+// Unrolled doubly linked list: each block holds up to CAPACITY elements in
+// a contiguous array, sized so a block spans about BlockBytes (four cache
+// lines by default). Traversal walks arrays instead of chasing one pointer
+// per element, and the two links plus the count are shared by a whole
+// block, so for small T the overhead is about a byte per element instead
+// of the 16-24 bytes of a list/dlist node.
+//
+// A full block is split in half on insert; a block that drops below a
+// quarter full after erase is merged with its successor when they fit in
+// one block. Iterators are invalidated by every insert and erase.
+template<typename T, std::size_t BlockBytes = 256>
+class unrolledList {
+    static constexpr std::size_t HEADER = 2 * sizeof(void*) + sizeof(std::size_t);
+    static constexpr std::size_t FIT = BlockBytes > HEADER ? (BlockBytes - HEADER) / sizeof(T) : 0;
+
+public:
+    static constexpr std::size_t CAPACITY = FIT < 4 ? 4 : FIT;
+
+    using value_type = T;
+    using size_type = std::size_t;
+    using reference = T&;
+    using const_reference = const T&;
+    using pointer = T*;
+    using const_pointer = const T*;
+
+private:
+    struct block {
+        block* next;
+        block* prev;
+        size_type count;
+        alignas(T) unsigned char storage[CAPACITY * sizeof(T)];
+
+        block() : next(nullptr), prev(nullptr), count(0) {}
+        T* data() { return std::launder(reinterpret_cast<T*>(storage)); }
+        const T* data() const { return std::launder(reinterpret_cast<const T*>(storage)); }
+    };
+
+    block* head;
+    block* tail;
+    size_type size_;
+
+    block* link_after_(block* b);
+    void unlink_(block* b);
+    block* split_(block* b);
+    template<typename U>
+    void emplace_at_(block* b, size_type i, U&& value);
+    void erase_at_(block* b, size_type i);
+
+    template<bool IsConst>
+    class basic_iterator {
+        using block_ptr = typename std::conditional<IsConst, const block*, block*>::type;
+        using list_ptr = typename std::conditional<IsConst, const unrolledList*, unrolledList*>::type;
+        block_ptr b;
+        size_type i;
+        list_ptr owner;
+        friend class unrolledList;
+        template<bool> friend class basic_iterator;
+        basic_iterator(block_ptr b_, size_type i_, list_ptr owner_) : b(b_), i(i_), owner(owner_) {}
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = typename std::conditional<IsConst, const T*, T*>::type;
+        using reference = typename std::conditional<IsConst, const T&, T&>::type;
+
+        basic_iterator() : b(nullptr), i(0), owner(nullptr) {}
+        operator basic_iterator<true>() const { return basic_iterator<true>(b, i, owner); }
+        reference operator*() const { return b->data()[i]; }
+        pointer operator->() const { return &b->data()[i]; }
+        basic_iterator& operator++(){
+            if(++i == b->count){
+                b = b->next;
+                i = 0;
+            }
+            return *this;
+        }
+        basic_iterator operator++(int) { basic_iterator tmp = *this; ++*this; return tmp; }
+        basic_iterator& operator--(){
+            if(!b){
+                b = owner->tail;
+                i = b->count - 1;
+            }
+            else if(i == 0){
+                b = b->prev;
+                i = b->count - 1;
+            }
+            else --i;
+            return *this;
+        }
+        basic_iterator operator--(int) { basic_iterator tmp = *this; --*this; return tmp; }
+        bool operator==(const basic_iterator& other) const { return b == other.b && i == other.i; }
+        bool operator!=(const basic_iterator& other) const { return !(*this == other); }
+    };
+
+public:
+    using iterator = basic_iterator<false>;
+    using const_iterator = basic_iterator<true>;
+
+    unrolledList() noexcept;
+    unrolledList(const unrolledList& other);
+    unrolledList(unrolledList&& other) noexcept;
+    unrolledList(std::initializer_list<T> init);
+    ~unrolledList();
+
+    unrolledList& operator=(const unrolledList& other);
+    unrolledList& operator=(unrolledList&& other) noexcept;
+
+    void push_front(const_reference value);
+    void push_front(T&& value);
+    void push_back(const_reference value);
+    void push_back(T&& value);
+    void pop_front();
+    void pop_back();
+    iterator insert(iterator pos, const_reference value);
+    iterator insert(iterator pos, T&& value);
+    iterator erase(iterator pos);
+    void clear();
+    bool empty() const { return size_ == 0; }
+    size_type size() const { return size_; }
+    void display() const;
+    reference front();
+    const_reference front() const;
+    reference back();
+    const_reference back() const;
+
+    iterator begin() { return iterator(head, 0, this); }
+    const_iterator begin() const { return const_iterator(head, 0, this); }
+    iterator end() { return iterator(nullptr, 0, this); }
+    const_iterator end() const { return const_iterator(nullptr, 0, this); }
+};
+
+template<typename T, std::size_t BlockBytes>
+unrolledList<T, BlockBytes>::unrolledList() noexcept : head(nullptr), tail(nullptr), size_(0){}
+
+template<typename T, std::size_t BlockBytes>
+unrolledList<T, BlockBytes>::unrolledList(const unrolledList& other) : head(nullptr), tail(nullptr), size_(0){
+    for(const T& value : other){
+        push_back(value);
+    }
+}
+
+template<typename T, std::size_t BlockBytes>
+unrolledList<T, BlockBytes>::unrolledList(unrolledList&& other) noexcept
+    : head(other.head), tail(other.tail), size_(other.size_){
+    other.head = nullptr;
+    other.tail = nullptr;
+    other.size_ = 0;
+}
+
+template<typename T, std::size_t BlockBytes>
+unrolledList<T, BlockBytes>::unrolledList(std::initializer_list<T> init) : head(nullptr), tail(nullptr), size_(0){
+    for(auto &i : init){
+        push_back(i);
+    }
+}
+
+template<typename T, std::size_t BlockBytes>
+unrolledList<T, BlockBytes>::~unrolledList(){
+    clear();
+}
+
+template<typename T, std::size_t BlockBytes>
+unrolledList<T, BlockBytes>& unrolledList<T, BlockBytes>::operator=(const unrolledList& other){
+    if(this != &other){
+        clear();
+        for(const T& value : other){
+            push_back(value);
+        }
+    }
+    return *this;
+}
+
+template<typename T, std::size_t BlockBytes>
+unrolledList<T, BlockBytes>& unrolledList<T, BlockBytes>::operator=(unrolledList&& other) noexcept{
+    if(this != &other){
+        clear();
+        head = other.head;
+        tail = other.tail;
+        size_ = other.size_;
+        other.head = nullptr;
+        other.tail = nullptr;
+        other.size_ = 0;
+    }
+    return *this;
+}
+
+// New empty block after b, or at the front when b is nullptr.
+template<typename T, std::size_t BlockBytes>
+typename unrolledList<T, BlockBytes>::block* unrolledList<T, BlockBytes>::link_after_(block* b){
+    block* fresh = new block();
+    fresh->prev = b;
+    fresh->next = b ? b->next : head;
+    if(fresh->next) fresh->next->prev = fresh;
+    else tail = fresh;
+    if(b) b->next = fresh;
+    else head = fresh;
+    return fresh;
+}
+
+// Frees an empty block.
+template<typename T, std::size_t BlockBytes>
+void unrolledList<T, BlockBytes>::unlink_(block* b){
+    if(b->prev) b->prev->next = b->next;
+    else head = b->next;
+    if(b->next) b->next->prev = b->prev;
+    else tail = b->prev;
+    delete b;
+}
+
+// Moves the upper half of a full block into a new block after it.
+template<typename T, std::size_t BlockBytes>
+typename unrolledList<T, BlockBytes>::block* unrolledList<T, BlockBytes>::split_(block* b){
+    block* fresh = link_after_(b);
+    size_type keep = b->count / 2;
+    T* from = b->data();
+    T* to = fresh->data();
+    for(size_type k = keep; k < b->count; ++k){
+        new (to + (k - keep)) T(std::move(from[k]));
+        from[k].~T();
+    }
+    fresh->count = b->count - keep;
+    b->count = keep;
+    return fresh;
+}
+
+// Constructs value at index i of a block with room, shifting the tail of
+// the block one slot up.
+template<typename T, std::size_t BlockBytes>
+template<typename U>
+void unrolledList<T, BlockBytes>::emplace_at_(block* b, size_type i, U&& value){
+    T* data = b->data();
+    if(i == b->count){
+        new (data + i) T(std::forward<U>(value));
+    }
+    else{
+        T tmp(std::forward<U>(value));
+        new (data + b->count) T(std::move(data[b->count - 1]));
+        for(size_type k = b->count - 1; k > i; --k) data[k] = std::move(data[k - 1]);
+        data[i] = std::move(tmp);
+    }
+    ++b->count;
+    ++size_;
+}
+
+template<typename T, std::size_t BlockBytes>
+void unrolledList<T, BlockBytes>::erase_at_(block* b, size_type i){
+    T* data = b->data();
+    for(size_type k = i; k + 1 < b->count; ++k) data[k] = std::move(data[k + 1]);
+    data[b->count - 1].~T();
+    --b->count;
+    --size_;
+    if(b->count == 0){
+        unlink_(b);
+        return;
+    }
+    block* next = b->next;
+    if(b->count < CAPACITY / 4 && next && b->count + next->count <= CAPACITY){
+        T* from = next->data();
+        for(size_type k = 0; k < next->count; ++k){
+            new (data + b->count + k) T(std::move(from[k]));
+            from[k].~T();
+        }
+        b->count += next->count;
+        next->count = 0;
+        unlink_(next);
+    }
+}
+
+template<typename T, std::size_t BlockBytes>
+void unrolledList<T, BlockBytes>::push_front(const_reference value){
+    if(!head || head->count == CAPACITY) link_after_(nullptr);
+    emplace_at_(head, 0, value);
+}
+
+template<typename T, std::size_t BlockBytes>
+void unrolledList<T, BlockBytes>::push_front(T&& value){
+    if(!head || head->count == CAPACITY) link_after_(nullptr);
+    emplace_at_(head, 0, std::move(value));
+}
+
+template<typename T, std::size_t BlockBytes>
+void unrolledList<T, BlockBytes>::push_back(const_reference value){
+    if(!tail || tail->count == CAPACITY) link_after_(tail);
+    emplace_at_(tail, tail->count, value);
+}
+
+template<typename T, std::size_t BlockBytes>
+void unrolledList<T, BlockBytes>::push_back(T&& value){
+    if(!tail || tail->count == CAPACITY) link_after_(tail);
+    emplace_at_(tail, tail->count, std::move(value));
+}
+
+template<typename T, std::size_t BlockBytes>
+void unrolledList<T, BlockBytes>::pop_front(){
+    if(empty()) return;
+    erase_at_(head, 0);
+}
+
+template<typename T, std::size_t BlockBytes>
+void unrolledList<T, BlockBytes>::pop_back(){
+    if(empty()) return;
+    erase_at_(tail, tail->count - 1);
+}
+
+// Inserts before pos and returns an iterator to the new element.
+template<typename T, std::size_t BlockBytes>
+typename unrolledList<T, BlockBytes>::iterator unrolledList<T, BlockBytes>::insert(iterator pos, const_reference value){
+    T copy(value);
+    return insert(pos, std::move(copy));
+}
+
+template<typename T, std::size_t BlockBytes>
+typename unrolledList<T, BlockBytes>::iterator unrolledList<T, BlockBytes>::insert(iterator pos, T&& value){
+    if(pos.owner != this){
+        throw std::out_of_range("Итератор вне диапазона списка.");
+    }
+    if(!pos.b){
+        push_back(std::move(value));
+        return iterator(tail, tail->count - 1, this);
+    }
+    block* b = pos.b;
+    size_type i = pos.i;
+    if(b->count == CAPACITY){
+        block* upper = split_(b);
+        if(i > b->count){
+            i -= b->count;
+            b = upper;
+        }
+    }
+    emplace_at_(b, i, std::move(value));
+    return iterator(b, i, this);
+}
+
+// Removes the element at pos and returns an iterator to the one after it.
+template<typename T, std::size_t BlockBytes>
+typename unrolledList<T, BlockBytes>::iterator unrolledList<T, BlockBytes>::erase(iterator pos){
+    if(pos.owner != this || !pos.b){
+        throw std::out_of_range("Итератор вне диапазона списка.");
+    }
+    block* b = pos.b;
+    size_type i = pos.i;
+    if(b->count == 1){
+        // The block is freed; the next element opens the following block.
+        block* next = b->next;
+        erase_at_(b, i);
+        return iterator(next, 0, this);
+    }
+    erase_at_(b, i);
+    if(i < b->count) return iterator(b, i, this);
+    return iterator(b->next, 0, this);
+}
+
+template<typename T, std::size_t BlockBytes>
+void unrolledList<T, BlockBytes>::clear(){
+    block* b = head;
+    while(b){
+        block* next = b->next;
+        T* data = b->data();
+        for(size_type k = 0; k < b->count; ++k) data[k].~T();
+        delete b;
+        b = next;
+    }
+    head = tail = nullptr;
+    size_ = 0;
+}
+
+template<typename T, std::size_t BlockBytes>
+void unrolledList<T, BlockBytes>::display() const{
+    for(const T& value : *this){
+        std::cout << value << " -> ";
+    }
+    std::cout << "nullptr" << std::endl;
+}
+
+template<typename T, std::size_t BlockBytes>
+typename unrolledList<T, BlockBytes>::reference unrolledList<T, BlockBytes>::front(){
+    if(empty()){
+        throw std::out_of_range("Список пуст. Невозможно получить первый элемент.");
+    }
+    return head->data()[0];
+}
+
+template<typename T, std::size_t BlockBytes>
+typename unrolledList<T, BlockBytes>::const_reference unrolledList<T, BlockBytes>::front() const{
+    if(empty()){
+        throw std::out_of_range("Список пуст. Невозможно получить первый элемент.");
+    }
+    return head->data()[0];
+}
+
+template<typename T, std::size_t BlockBytes>
+typename unrolledList<T, BlockBytes>::reference unrolledList<T, BlockBytes>::back(){
+    if(empty()){
+        throw std::out_of_range("Список пуст. Невозможно получить последний элемент.");
+    }
+    return tail->data()[tail->count - 1];
+}
+
+template<typename T, std::size_t BlockBytes>
+typename unrolledList<T, BlockBytes>::const_reference unrolledList<T, BlockBytes>::back() const{
+    if(empty()){
+        throw std::out_of_range("Список пуст. Невозможно получить последний элемент.");
+    }
+    return tail->data()[tail->count - 1];
+}
+
+#endif // UNROLLED_LIST_HPP
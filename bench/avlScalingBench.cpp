@@ -0,0 +1,44 @@
+// Insert/remove scaling of avl: if both stay O(log n), the time per
+// operation divided by log2(n) stays roughly flat as n grows.
+//
+//   g++ -std=c++17 -O2 -pthread bench/avlScalingBench.cpp -o avlScalingBench
+//   ./avlScalingBench [max keys]          (default 10M; 100M needs ~5 GB)
+//
+// Keys are distinct and arrive in a scrambled order (i * odd constant
+// mod 2^32), so the tree is not fed a sorted run.
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include "../Binary Tree/avl.hpp"
+
+static int key(uint64_t i){
+    return static_cast<int>(static_cast<uint32_t>(i * 2654435761u));
+}
+
+int main(int argc, char** argv){
+    uint64_t maxKeys = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+
+    std::printf("%12s %12s %12s %16s %16s\n", "keys", "insert ns", "remove ns",
+                "insert/log2 n", "remove/log2 n");
+    for(uint64_t n = 100000; n <= maxKeys; n *= 10){
+        avl<int> tree;
+        auto t0 = std::chrono::steady_clock::now();
+        for(uint64_t i = 0; i < n; ++i) tree.insert(key(i));
+        auto t1 = std::chrono::steady_clock::now();
+        for(uint64_t i = 0; i < n; ++i) tree.remove(key(i));
+        auto t2 = std::chrono::steady_clock::now();
+        if(!tree.empty()){
+            std::fprintf(stderr, "tree not empty after removing every key\n");
+            return 1;
+        }
+
+        double insertNs = std::chrono::duration<double, std::nano>(t1 - t0).count() / n;
+        double removeNs = std::chrono::duration<double, std::nano>(t2 - t1).count() / n;
+        double lg = std::log2(static_cast<double>(n));
+        std::printf("%12llu %12.1f %12.1f %16.2f %16.2f\n", static_cast<unsigned long long>(n),
+                    insertNs, removeNs, insertNs / lg, removeNs / lg);
+    }
+}
@@ -0,0 +1,53 @@
+// Read scaling of concurrentSkipList: lookups alone, and lookups with a 10%
+// insert/remove mix, at growing thread counts. Linear scaling shows as a
+// constant Mops/s per thread.
+//
+//   g++ -std=c++17 -O2 -pthread bench/concurrentSkipListBench.cpp -o concurrentSkipListBench
+//   ./concurrentSkipListBench [ops per thread] [max threads] [keys]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <vector>
+#include "../List/concurrentSkipList.hpp"
+
+double run(concurrentSkipList<int>& list, unsigned threads, size_t opsPerThread, int keys, unsigned writePercent){
+    std::vector<std::thread> pool;
+    auto start = std::chrono::steady_clock::now();
+    for(unsigned t = 0; t < threads; ++t){
+        pool.emplace_back([&list, opsPerThread, keys, writePercent, t]{
+            std::mt19937 rng(t + 1);
+            size_t hits = 0;
+            for(size_t i = 0; i < opsPerThread; ++i){
+                int key = static_cast<int>(rng() % keys);
+                unsigned op = rng() % 100;
+                if(op < writePercent / 2) list.insert(key);
+                else if(op < writePercent) list.remove(key);
+                else hits += list.search(key);
+            }
+            if(hits == size_t(-1)) std::printf("unreachable\n");
+        });
+    }
+    for(auto& th : pool) th.join();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return threads * opsPerThread / elapsed.count() / 1e6;
+}
+
+int main(int argc, char** argv){
+    size_t ops = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2000000;
+    unsigned maxThreads = argc > 2 ? std::atoi(argv[2]) : std::thread::hardware_concurrency();
+    int keys = argc > 3 ? std::atoi(argv[3]) : 1000000;
+    if(maxThreads == 0) maxThreads = 1;
+
+    concurrentSkipList<int> list;
+    for(int k = 0; k < keys; k += 2) list.insert(k);
+
+    std::printf("%8s %18s %18s %18s\n", "threads", "reads Mops/s", "per thread", "10% writes Mops/s");
+    for(unsigned threads = 1; threads <= maxThreads; threads *= 2){
+        double reads = run(list, threads, ops, keys, 0);
+        double mixed = run(list, threads, ops, keys, 10);
+        std::printf("%8u %18.2f %18.2f %18.2f\n", threads, reads, reads / threads, mixed);
+    }
+}
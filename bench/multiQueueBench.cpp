@@ -0,0 +1,52 @@
+// Contention benchmark for multiQueue: relaxed lanes vs the strict single
+// mutex heap, at growing thread counts.
+//
+//   g++ -std=c++17 -O2 -pthread bench/multiQueueBench.cpp -o multiQueueBench
+//   ./multiQueueBench [ops per thread] [max threads]
+//
+// Every thread alternates push and try_pop on a queue prefilled with 1M
+// keys, so the queue stays about the same size for the whole run.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include <random>
+#include "../Binary Tree/multiQueue.hpp"
+
+template<bool strict>
+double run(unsigned threads, size_t opsPerThread){
+    multiQueue<int, strict> queue(threads);
+    std::mt19937 rng(42);
+    for(int i = 0; i < (1 << 20); ++i) queue.push(static_cast<int>(rng()));
+
+    std::vector<std::thread> pool;
+    auto start = std::chrono::steady_clock::now();
+    for(unsigned t = 0; t < threads; ++t){
+        pool.emplace_back([&queue, opsPerThread, t]{
+            std::mt19937 local(t);
+            int out;
+            for(size_t i = 0; i < opsPerThread; ++i){
+                if(i & 1) queue.try_pop(out);
+                else queue.push(static_cast<int>(local()));
+            }
+        });
+    }
+    for(auto& th : pool) th.join();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return threads * opsPerThread / elapsed.count() / 1e6;
+}
+
+int main(int argc, char** argv){
+    size_t ops = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    unsigned maxThreads = argc > 2 ? std::atoi(argv[2]) : std::thread::hardware_concurrency();
+    if(maxThreads == 0) maxThreads = 1;
+
+    std::printf("%8s %16s %16s\n", "threads", "strict Mops/s", "relaxed Mops/s");
+    for(unsigned threads = 1; threads <= maxThreads; threads *= 2){
+        double strict = run<true>(threads, ops);
+        double relaxed = run<false>(threads, ops);
+        std::printf("%8u %16.2f %16.2f\n", threads, strict, relaxed);
+    }
+}
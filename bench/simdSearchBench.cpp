@@ -0,0 +1,60 @@
+// simdLowerBound against std::lower_bound on sorted arrays sized from L1 to
+// DRAM.
+//
+//   g++ -std=c++17 -O2 -march=native bench/simdSearchBench.cpp -o simdSearchBench
+//   ./simdSearchBench [max bytes]         (default 256 MB)
+//
+// Without -march (or -mavx2) the kernels fall back to SSE2 on x86-64. Each
+// row runs the same random queries through both searches and checks that
+// they agree.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "../Binary Tree/simdSearch.hpp"
+
+template<typename T, typename Search>
+double timeQueries(const std::vector<T>& keys, const std::vector<T>& queries, Search search, size_t& checksum){
+    auto start = std::chrono::steady_clock::now();
+    for(const T& q : queries) checksum += search(keys.data(), keys.data() + keys.size(), q) - keys.data();
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / queries.size();
+}
+
+template<typename T>
+void run(const char* name, size_t maxBytes){
+    std::printf("\n%s\n%12s %10s %18s %18s %8s\n", name, "bytes", "keys", "std::lower_bound ns",
+                "simdLowerBound ns", "speedup");
+    std::mt19937_64 rng(7);
+    for(size_t bytes = 4096; bytes <= maxBytes; bytes *= 4){
+        size_t n = bytes / sizeof(T);
+        std::vector<T> keys(n);
+        for(size_t i = 0; i < n; ++i) keys[i] = static_cast<T>(2 * i);
+        std::vector<T> queries(1 << 20);
+        for(T& q : queries) q = static_cast<T>(rng() % (2 * n + 1));
+
+        size_t expect = 0, got = 0;
+        double stdNs = timeQueries(keys, queries, [](const T* f, const T* l, const T& k){
+            return std::lower_bound(f, l, k);
+        }, expect);
+        double simdNs = timeQueries(keys, queries, [](const T* f, const T* l, const T& k){
+            return simdLowerBound(f, l, k);
+        }, got);
+        if(expect != got){
+            std::fprintf(stderr, "results differ at %zu keys\n", n);
+            std::exit(1);
+        }
+        std::printf("%12zu %10zu %18.1f %18.1f %7.2fx\n", bytes, n, stdNs, simdNs, stdNs / simdNs);
+    }
+}
+
+int main(int argc, char** argv){
+    size_t maxBytes = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : (size_t(256) << 20);
+    run<int32_t>("int32_t", maxBytes);
+    run<int64_t>("int64_t", maxBytes);
+    run<double>("double", maxBytes);
+}